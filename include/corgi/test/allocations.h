@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstddef>
+
+namespace corgi
+{
+namespace test
+{
+/*!
+ * @brief Heap allocations made between two points of a thread
+ *
+ * Only filled when allocation tracking is enabled, by defining
+ * CORGI_TEST_TRACK_ALLOCATIONS in one translation unit before including
+ * corgi/test/test.h. That translation unit then replaces the global
+ * operator new and operator delete.
+ */
+struct allocation_stats
+{
+    std::size_t allocations {0};
+    std::size_t bytes {0};         // Total requested, freed or not
+    std::size_t peak_bytes {0};    // Most bytes alive at the same time
+};
+
+namespace detail
+{
+/*!
+ * @brief What the current thread allocated since it started
+ *
+ * Memory freed by another thread than the one that allocated it lowers the
+ * live bytes of the freeing thread, which is why they're signed.
+ */
+struct allocation_counters
+{
+    std::size_t allocations;
+    std::size_t bytes;
+    long long   live_bytes;
+    long long   peak_bytes;
+};
+
+inline thread_local allocation_counters thread_allocations {0, 0, 0, 0};
+
+/*!
+ * @brief Set once the replaced operator new is part of the program
+ */
+inline bool allocation_tracking {false};
+
+inline void record_allocation(std::size_t size) noexcept
+{
+    auto& counters = thread_allocations;
+    counters.allocations++;
+    counters.bytes += size;
+    counters.live_bytes += static_cast<long long>(size);
+
+    if(counters.live_bytes > counters.peak_bytes)
+        counters.peak_bytes = counters.live_bytes;
+}
+
+inline void record_deallocation(std::size_t size) noexcept
+{
+    thread_allocations.live_bytes -= static_cast<long long>(size);
+}
+
+/*!
+ * @brief Measures the allocations made by the current thread from the moment
+ * it was started
+ *
+ * The scope can be paused, so a coroutine only counts what it allocated while
+ * it was resumed, and not what the tests running in between allocated. The
+ * peak is relative to the bytes that were already alive when the scope
+ * started or was last resumed.
+ *
+ * Scopes nest, like a benchmark measured inside a test: the thread's peak is
+ * reset while a scope counts, and raised back to the outer one's when it
+ * pauses or ends.
+ */
+class allocation_scope
+{
+public:
+    allocation_scope() = default;
+
+    allocation_scope(const allocation_scope&)            = delete;
+    allocation_scope& operator=(const allocation_scope&) = delete;
+
+    ~allocation_scope() { pause(); }
+
+    void start() noexcept
+    {
+        pause();
+        _counted = allocation_stats {};
+        resume();
+    }
+
+    /*!
+     * @brief Stops counting, keeping what was counted so far
+     */
+    void pause() noexcept
+    {
+        if(!_running)
+            return;
+
+        _counted = stats();
+        _running = false;
+
+        auto& counters = thread_allocations;
+        if(_outer_peak > counters.peak_bytes)
+            counters.peak_bytes = _outer_peak;
+    }
+
+    /*!
+     * @brief Counts again after @ref pause. Does nothing if the scope is
+     * already counting
+     */
+    void resume() noexcept
+    {
+        if(_running)
+            return;
+
+        auto& counters      = thread_allocations;
+        _outer_peak         = counters.peak_bytes;
+        counters.peak_bytes = counters.live_bytes;
+        _start              = counters;
+        _running            = true;
+    }
+
+    allocation_stats stats() const noexcept
+    {
+        allocation_stats result = _counted;
+
+        if(!_running)
+            return result;
+
+        const auto& counters = thread_allocations;
+        result.allocations += counters.allocations - _start.allocations;
+        result.bytes += counters.bytes - _start.bytes;
+
+        if(counters.peak_bytes > _start.live_bytes)
+        {
+            const auto peak = static_cast<std::size_t>(counters.peak_bytes -
+                                                       _start.live_bytes);
+            if(peak > result.peak_bytes)
+                result.peak_bytes = peak;
+        }
+        return result;
+    }
+
+private:
+    allocation_counters _start {0, 0, 0, 0};
+    allocation_stats    _counted;
+    long long           _outer_peak {0};
+    bool                _running {false};
+};
+}    // namespace detail
+}    // namespace test
+}    // namespace corgi
@@ -0,0 +1,487 @@
+#pragma once
+
+// Coroutines for TEST_ASYNC, and the event loop resuming them. Only available
+// on Linux, in C++20, where CORGI_TEST_HAS_ASYNC gets defined
+
+#if defined(__linux__) && defined(__cpp_impl_coroutine) &&                     \
+    __has_include(<coroutine>)
+#    define CORGI_TEST_HAS_ASYNC 1
+#endif
+
+#ifdef CORGI_TEST_HAS_ASYNC
+
+#    include <algorithm>
+#    include <cerrno>
+#    include <chrono>
+#    include <coroutine>
+#    include <cstddef>
+#    include <cstdint>
+#    include <exception>
+#    include <functional>
+#    include <future>
+#    include <optional>
+#    include <stdexcept>
+#    include <string>
+#    include <system_error>
+#    include <unordered_map>
+#    include <utility>
+#    include <vector>
+
+#    include <sys/epoll.h>
+#    include <unistd.h>
+
+namespace corgi
+{
+namespace test
+{
+template<class T>
+class task;
+
+namespace detail
+{
+struct test_context;
+
+/*!
+ * @brief What the thread must point to whenever a coroutine test resumes
+ */
+struct async_state
+{
+    test_context* context {nullptr};
+    std::string*  output {nullptr};
+};
+
+/*!
+ * @brief Resumes @p handle with the context and output of @p state.
+ * Defined in corgi/test/test.h, which knows the test contexts
+ */
+inline void resume_test(async_state& state, std::coroutine_handle<> handle);
+
+/*!
+ * @brief Resumes suspended coroutines once what they wait for is ready
+ *
+ * Coroutines wait on timers, on file descriptors watched by epoll, or on
+ * futures, which are polled every millisecond. Everything runs on the
+ * thread calling @ref run_once.
+ */
+class event_loop
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    event_loop() : _epoll(epoll_create1(EPOLL_CLOEXEC))
+    {
+        if(_epoll < 0)
+            throw std::system_error(errno, std::generic_category(),
+                                    "Could not create the event loop");
+    }
+
+    event_loop(const event_loop&)            = delete;
+    event_loop& operator=(const event_loop&) = delete;
+
+    ~event_loop() { ::close(_epoll); }
+
+    void schedule(std::coroutine_handle<> handle, async_state* state)
+    {
+        _ready.push_back({handle, state});
+    }
+
+    void add_timer(clock::time_point       deadline,
+                   std::coroutine_handle<> handle,
+                   async_state*            state)
+    {
+        _timers.push_back({deadline, _timer_count++, {handle, state}});
+        std::push_heap(_timers.begin(), _timers.end(), later);
+    }
+
+    /*!
+     * @brief Resumes @p handle once @p fd has one of the epoll @p events
+     *
+     * Only one coroutine can wait on a given file descriptor at a time.
+     * Throws std::system_error if epoll can't watch @p fd
+     */
+    void add_fd(int                     fd,
+                std::uint32_t           events,
+                std::coroutine_handle<> handle,
+                async_state*            state)
+    {
+        if(_fds.count(fd) != 0)
+            throw std::logic_error("Another coroutine already waits on fd " +
+                                   std::to_string(fd));
+
+        epoll_event event {};
+        event.events  = events | EPOLLONESHOT;
+        event.data.fd = fd;
+
+        if(epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event) != 0)
+            throw std::system_error(errno, std::generic_category(),
+                                    "Could not wait on fd " +
+                                        std::to_string(fd));
+
+        _fds[fd] = {handle, state};
+    }
+
+    void add_poll(std::function<bool()>   ready,
+                  std::coroutine_handle<> handle,
+                  async_state*            state)
+    {
+        _polls.push_back({std::move(ready), {handle, state}});
+    }
+
+    /*!
+     * @brief Waits for at least one coroutine to be ready, and resumes every
+     * ready one
+     *
+     * @return False if no coroutine waits on anything
+     */
+    bool run_once()
+    {
+        if(_ready.empty() && _timers.empty() && _fds.empty() &&
+           _polls.empty())
+            return false;
+
+        if(_ready.empty())
+            wait();
+
+        auto ready = std::move(_ready);
+        _ready.clear();
+
+        for(auto& waiter : ready)
+            resume_test(*waiter.state, waiter.handle);
+        return true;
+    }
+
+private:
+    struct waiter
+    {
+        std::coroutine_handle<> handle;
+        async_state*            state;
+    };
+
+    struct timer
+    {
+        clock::time_point deadline;
+        std::uint64_t     order;    // Timers with the same deadline stay FIFO
+        waiter            target;
+    };
+
+    struct poll
+    {
+        std::function<bool()> ready;
+        waiter                target;
+    };
+
+    static bool later(const timer& a, const timer& b)
+    {
+        return a.deadline != b.deadline ? a.deadline > b.deadline :
+                                          a.order > b.order;
+    }
+
+    /*!
+     * @brief Moves what became ready to the ready list, blocking inside
+     * epoll_wait until something does
+     */
+    void wait()
+    {
+        int timeout = -1;
+        if(!_polls.empty())
+            timeout = 1;
+        if(!_timers.empty())
+        {
+            const auto left =
+                std::chrono::ceil<std::chrono::milliseconds>(
+                    _timers.front().deadline - clock::now())
+                    .count();
+            const auto until_timer = static_cast<int>(
+                std::clamp<long long>(left, 0, 1000 * 60 * 60));
+            timeout =
+                timeout < 0 ? until_timer : std::min(timeout, until_timer);
+        }
+
+        epoll_event events[64];
+        const int   count = epoll_wait(_epoll, events, 64, timeout);
+
+        if(count < 0 && errno != EINTR)
+            throw std::system_error(errno, std::generic_category(),
+                                    "Could not wait for events");
+
+        for(int i = 0; i < count; i++)
+        {
+            const int fd = events[i].data.fd;
+            epoll_ctl(_epoll, EPOLL_CTL_DEL, fd, nullptr);
+
+            _ready.push_back(_fds[fd]);
+            _fds.erase(fd);
+        }
+
+        const auto now = clock::now();
+        while(!_timers.empty() && _timers.front().deadline <= now)
+        {
+            std::pop_heap(_timers.begin(), _timers.end(), later);
+            _ready.push_back(_timers.back().target);
+            _timers.pop_back();
+        }
+
+        for(std::size_t i = 0; i < _polls.size();)
+            if(_polls[i].ready())
+            {
+                _ready.push_back(_polls[i].target);
+                _polls.erase(_polls.begin() + static_cast<std::ptrdiff_t>(i));
+            }
+            else
+                i++;
+    }
+
+    int                             _epoll;
+    std::vector<waiter>             _ready;
+    std::vector<timer>              _timers;
+    std::uint64_t                   _timer_count {0};
+    std::unordered_map<int, waiter> _fds;
+    std::vector<poll>               _polls;
+};
+
+/*!
+ * @brief Loop running the coroutines of the current thread, and the state of
+ * the coroutine test being resumed
+ */
+inline thread_local event_loop*  current_loop {nullptr};
+inline thread_local async_state* current_async {nullptr};
+
+/*!
+ * @brief Loop the coroutine being suspended goes back to. Throws
+ * std::logic_error outside of a TEST_ASYNC
+ */
+inline event_loop& loop()
+{
+    if(current_loop == nullptr)
+        throw std::logic_error("co_await can only be used inside TEST_ASYNC");
+    return *current_loop;
+}
+
+struct task_promise_base
+{
+    std::coroutine_handle<> continuation;    // Null for a test's body
+    std::exception_ptr      exception;
+
+    /*!
+     * @brief Hands the thread back to the awaiting coroutine, or to the loop
+     */
+    struct final_awaiter
+    {
+        bool await_ready() noexcept { return false; }
+
+        template<class Promise>
+        std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            const auto next = handle.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    final_awaiter       final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() { exception = std::current_exception(); }
+};
+
+template<class T>
+struct task_promise : task_promise_base
+{
+    task<T> get_return_object();
+
+    void return_value(T value) { result.emplace(std::move(value)); }
+
+    T take()
+    {
+        if(exception)
+            std::rethrow_exception(exception);
+        return std::move(*result);
+    }
+
+    std::optional<T> result;
+};
+
+template<>
+struct task_promise<void> : task_promise_base
+{
+    task<void> get_return_object();
+
+    void return_void() {}
+
+    void take()
+    {
+        if(exception)
+            std::rethrow_exception(exception);
+    }
+};
+}    // namespace detail
+
+/*!
+ * @brief Coroutine returning a @p T, started once it is awaited
+ *
+ * The body of a TEST_ASYNC is a task<>, and can await other tasks.
+ */
+template<class T = void>
+class task
+{
+public:
+    using promise_type = detail::task_promise<T>;
+    using handle_type  = std::coroutine_handle<promise_type>;
+
+    explicit task(handle_type handle) : _handle(handle) {}
+
+    task(task&& other) noexcept : _handle(std::exchange(other._handle, {})) {}
+
+    task& operator=(task&& other) noexcept
+    {
+        if(this != &other)
+        {
+            if(_handle)
+                _handle.destroy();
+            _handle = std::exchange(other._handle, {});
+        }
+        return *this;
+    }
+
+    ~task()
+    {
+        if(_handle)
+            _handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting)
+    {
+        _handle.promise().continuation = awaiting;
+        return _handle;
+    }
+
+    T await_resume() { return _handle.promise().take(); }
+
+    handle_type handle() const { return _handle; }
+
+private:
+    handle_type _handle;
+};
+
+namespace detail
+{
+template<class T>
+task<T> task_promise<T>::get_return_object()
+{
+    return task<T>(task<T>::handle_type::from_promise(*this));
+}
+
+inline task<void> task_promise<void>::get_return_object()
+{
+    return task<void>(task<void>::handle_type::from_promise(*this));
+}
+
+/*!
+ * @brief Awaited by sleep_for
+ */
+struct sleep_awaiter
+{
+    event_loop::clock::time_point deadline;
+
+    bool await_ready() const
+    {
+        return deadline <= event_loop::clock::now();
+    }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        loop().add_timer(deadline, handle, current_async);
+    }
+
+    void await_resume() const noexcept {}
+};
+
+/*!
+ * @brief Awaited by readable and writable
+ */
+struct fd_awaiter
+{
+    int           fd;
+    std::uint32_t events;
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        loop().add_fd(fd, events, handle, current_async);
+    }
+
+    void await_resume() const noexcept {}
+};
+
+/*!
+ * @brief Awaited by wait, returns what the future holds
+ */
+template<class T>
+struct future_awaiter
+{
+    std::future<T>& future;
+
+    bool is_ready() const
+    {
+        return future.wait_for(std::chrono::seconds(0)) ==
+               std::future_status::ready;
+    }
+
+    bool await_ready() const { return is_ready(); }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        loop().add_poll([this]() { return is_ready(); }, handle,
+                        current_async);
+    }
+
+    T await_resume() { return future.get(); }
+};
+}    // namespace detail
+
+/*!
+ * @brief Suspends the coroutine for @p duration, letting other tests run
+ */
+template<class Rep, class Period>
+detail::sleep_awaiter sleep_for(std::chrono::duration<Rep, Period> duration)
+{
+    return {detail::event_loop::clock::now() +
+            std::chrono::duration_cast<detail::event_loop::clock::duration>(
+                duration)};
+}
+
+/*!
+ * @brief Suspends the coroutine until @p fd can be read without blocking,
+ * or was closed on the other end
+ */
+inline detail::fd_awaiter readable(int fd)
+{
+    return {fd, EPOLLIN | EPOLLRDHUP};
+}
+
+/*!
+ * @brief Suspends the coroutine until @p fd can be written without blocking
+ */
+inline detail::fd_awaiter writable(int fd)
+{
+    return {fd, EPOLLOUT};
+}
+
+/*!
+ * @brief Suspends the coroutine until @p future is ready, and returns its
+ * value. The future must outlive the co_await
+ */
+template<class T>
+detail::future_awaiter<T> wait(std::future<T>& future)
+{
+    return {future};
+}
+}    // namespace test
+}    // namespace corgi
+
+#endif
@@ -0,0 +1,144 @@
+#pragma once
+
+// Replaces the global operator new and operator delete so every allocation is
+// counted by the thread that makes it. Only included by corgi/test/test.h when
+// CORGI_TEST_TRACK_ALLOCATIONS is defined, and that must only happen inside a
+// single translation unit of the program, or the linker will complain about
+// the operators being defined more than once.
+//
+// The size of a block is stored in front of it, so even unsized deletes know
+// how many bytes they release. Over-aligned allocations go through the
+// operators taking a std::align_val_t, which aren't replaced and so aren't
+// counted.
+
+#include <corgi/test/allocations.h>
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace corgi
+{
+namespace test
+{
+namespace detail
+{
+constexpr std::size_t allocation_header = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+static_assert(allocation_header >= sizeof(std::size_t),
+              "The size of a block must fit in front of it");
+
+inline void* tracked_allocate(std::size_t size) noexcept
+{
+    auto* block = static_cast<unsigned char*>(
+        std::malloc(size + allocation_header));
+
+    if(block == nullptr)
+        return nullptr;
+
+    *reinterpret_cast<std::size_t*>(block) = size;
+    record_allocation(size);
+    return block + allocation_header;
+}
+
+inline void tracked_free(void* pointer) noexcept
+{
+    if(pointer == nullptr)
+        return;
+
+    auto* block = static_cast<unsigned char*>(pointer) - allocation_header;
+    record_deallocation(*reinterpret_cast<std::size_t*>(block));
+    std::free(block);
+}
+
+/*!
+ * @brief Follows what operator new must do when it runs out of memory : call
+ * the new handler until it gives up, then throw
+ */
+inline void* tracked_new(std::size_t size)
+{
+    for(;;)
+    {
+        if(void* pointer = tracked_allocate(size))
+            return pointer;
+
+        auto handler = std::get_new_handler();
+        if(handler == nullptr)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+struct allocation_tracking_installer
+{
+    allocation_tracking_installer() { allocation_tracking = true; }
+};
+
+static allocation_tracking_installer install_allocation_tracking;
+}    // namespace detail
+}    // namespace test
+}    // namespace corgi
+
+void* operator new(std::size_t size)
+{
+    return corgi::test::detail::tracked_new(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return corgi::test::detail::tracked_new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try
+    {
+        return corgi::test::detail::tracked_new(size);
+    }
+    catch(...)
+    {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    try
+    {
+        return corgi::test::detail::tracked_new(size);
+    }
+    catch(...)
+    {
+        return nullptr;
+    }
+}
+
+void operator delete(void* pointer) noexcept
+{
+    corgi::test::detail::tracked_free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    corgi::test::detail::tracked_free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    corgi::test::detail::tracked_free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    corgi::test::detail::tracked_free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    corgi::test::detail::tracked_free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    corgi::test::detail::tracked_free(pointer);
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#if defined(__linux__)
+#    include <cstring>
+#    include <linux/perf_event.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+namespace corgi
+{
+namespace test
+{
+/*!
+ * @brief Hardware events counted while a benchmarked function ran, divided by
+ * the number of calls
+ *
+ * A counter the system couldn't open is left empty.
+ */
+struct hardware_counters
+{
+    std::optional<double> cycles;
+    std::optional<double> instructions;
+    std::optional<double> l1d_misses;       // Level 1 data cache read misses
+    std::optional<double> llc_misses;       // Last level cache read misses
+    std::optional<double> branch_misses;
+
+    bool available() const
+    {
+        return cycles || instructions || l1d_misses || llc_misses ||
+               branch_misses;
+    }
+
+    /*!
+     * @brief Instructions per cycle, if both were counted
+     */
+    std::optional<double> ipc() const
+    {
+        if(!cycles || !instructions || *cycles <= 0.0)
+            return std::nullopt;
+        return *instructions / *cycles;
+    }
+};
+
+namespace detail
+{
+/*!
+ * @brief Reads the hardware counters of the calling thread through
+ * perf_event_open
+ *
+ * Every counter is opened on its own, so a missing one doesn't prevent the
+ * others from working. On systems without perf events, inside most containers
+ * or when kernel.perf_event_paranoid forbids it, nothing opens and the
+ * benchmarks only report timings.
+ */
+class perf_counters
+{
+public:
+    static constexpr std::size_t count = 5;
+
+    perf_counters()
+    {
+        _fds.fill(-1);
+#if defined(__linux__)
+        const auto cache_miss = [](std::uint64_t cache)
+        {
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+
+        open(0, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        open(1, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        open(2, PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D));
+        open(3, PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL));
+        open(4, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+    }
+
+    perf_counters(const perf_counters&)            = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+
+    ~perf_counters()
+    {
+#if defined(__linux__)
+        for(auto fd : _fds)
+            if(fd >= 0)
+                ::close(fd);
+#endif
+    }
+
+    bool available() const
+    {
+        for(auto fd : _fds)
+            if(fd >= 0)
+                return true;
+        return false;
+    }
+
+    void start()
+    {
+#if defined(__linux__)
+        for(auto fd : _fds)
+            if(fd >= 0)
+            {
+                ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+    }
+
+    /*!
+     * @brief Stops counting, and adds what was counted since @ref start to
+     * @p totals
+     *
+     * When the kernel had to share the hardware between more events than it
+     * has registers, the values are scaled by the time the event really ran.
+     */
+    void stop(std::array<double, count>& totals)
+    {
+#if defined(__linux__)
+        for(auto fd : _fds)
+            if(fd >= 0)
+                ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+        for(std::size_t i = 0; i < count; i++)
+        {
+            if(_fds[i] < 0)
+                continue;
+
+            std::uint64_t values[3] {};    // value, time enabled, time running
+            if(::read(_fds[i], values, sizeof(values)) !=
+               static_cast<ssize_t>(sizeof(values)))
+                continue;
+
+            double value = static_cast<double>(values[0]);
+            if(values[2] > 0 && values[2] < values[1])
+                value *= static_cast<double>(values[1]) /
+                         static_cast<double>(values[2]);
+            totals[i] += value;
+        }
+#else
+        (void)totals;
+#endif
+    }
+
+    /*!
+     * @brief Turns totals gathered over @p calls calls into per call values
+     */
+    hardware_counters per_call(const std::array<double, count>& totals,
+                               double                           calls) const
+    {
+        hardware_counters result;
+        std::optional<double>* fields[count] = {
+            &result.cycles, &result.instructions, &result.l1d_misses,
+            &result.llc_misses, &result.branch_misses};
+
+        for(std::size_t i = 0; i < count; i++)
+            if(_fds[i] >= 0 && calls > 0.0)
+                *fields[i] = totals[i] / calls;
+        return result;
+    }
+
+private:
+#if defined(__linux__)
+    void open(std::size_t index, std::uint32_t type, std::uint64_t config)
+    {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size           = sizeof(attributes);
+        attributes.type           = type;
+        attributes.config         = config;
+        attributes.disabled       = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv     = 1;
+        attributes.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                                 PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        _fds[index] = static_cast<int>(
+            ::syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0));
+    }
+#endif
+
+    std::array<int, count> _fds;
+};
+}    // namespace detail
+}    // namespace test
+}    // namespace corgi
@@ -0,0 +1,358 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define CORGI_TEST_HAS_SSE2 1
+#    include <emmintrin.h>
+#endif
+
+namespace corgi
+{
+namespace test
+{
+namespace detail
+{
+/*!
+ * @brief Elements of two ranges that didn't match, and where the first ones
+ * are
+ */
+struct range_mismatches
+{
+    static constexpr std::size_t kept = 8;    // Indices kept for the report
+
+    std::size_t count {0};
+    std::size_t indices[kept] {};
+
+    std::size_t kept_count() const { return std::min(count, kept); }
+};
+
+/*!
+ * @brief Elements must compare equal with operator==. NaN never matches
+ */
+struct exact_match
+{
+    template<class T>
+    bool fails(const T& a, const T& b) const
+    {
+        return !(a == b);
+    }
+};
+
+/*!
+ * @brief Elements must be equal, or closer than the largest of an absolute
+ * tolerance and a relative one, scaled by the largest magnitude of the two
+ *
+ * An infinite difference never matches, however large the tolerance.
+ */
+struct near_match
+{
+    double absolute {0.0};
+    double relative {0.0};
+
+    template<class T>
+    bool fails(T a, T b) const
+    {
+        const T magnitude = std::max(std::abs(a), std::abs(b));
+        const T tolerance =
+            std::max(static_cast<T>(absolute), static_cast<T>(relative) *
+                                                   magnitude);
+        const T distance = std::abs(a - b);
+        return !(a == b || (distance <= tolerance &&
+                            distance <= std::numeric_limits<T>::max()));
+    }
+};
+
+/*!
+ * @brief Elements must be at most a number of representable values apart.
+ * NaN never matches, and -0 matches 0
+ */
+struct ulp_match
+{
+    std::uint64_t max_ulps {0};
+
+    template<class T>
+    bool fails(T a, T b) const
+    {
+        static_assert(std::is_floating_point_v<T>,
+                      "Only floating point numbers have ulps");
+
+        if(std::isnan(a) || std::isnan(b))
+            return true;
+
+        const auto distance = ordered(a) > ordered(b) ?
+                                  ordered(a) - ordered(b) :
+                                  ordered(b) - ordered(a);
+        return distance > limit<T>();
+    }
+
+    /*!
+     * @brief Turns the bits of a float into an integer that grows with it
+     *
+     * Negative floats count down from 0, so the distance between two
+     * integers is the number of floats between them. The result is offset
+     * by 2^63 to stay positive.
+     */
+    template<class T>
+    static std::uint64_t ordered(T value)
+    {
+        using bits_type =
+            std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+        constexpr auto sign   = bits_type(1) << (sizeof(T) * 8 - 1);
+        constexpr auto offset = std::uint64_t(1) << 63;
+
+        bits_type bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        const auto magnitude = static_cast<std::uint64_t>(bits & ~sign);
+        return (bits & sign) != 0 ? offset - magnitude : offset + magnitude;
+    }
+
+    /*!
+     * @brief Largest distance allowed between two values of type T
+     *
+     * Floats are capped to 2^31 - 1, so the vectorized kernel can work on 32
+     * bits lanes. Two finite floats that far apart don't have much in common
+     * anyway.
+     */
+    template<class T>
+    std::uint64_t limit() const
+    {
+        if(sizeof(T) == 8)
+            return max_ulps;
+        return std::min<std::uint64_t>(
+            max_ulps, std::numeric_limits<std::int32_t>::max());
+    }
+};
+
+/*!
+ * @brief Counts the elements of @p a and @p b that don't match, one at a time
+ *
+ * There's no branch inside the loop, so compilers can vectorize it on their
+ * own for the types without a dedicated kernel.
+ */
+template<class Match, class T>
+std::size_t count_failures_scalar(const Match& match,
+                                  const T*     a,
+                                  const T*     b,
+                                  std::size_t  size)
+{
+    std::size_t count {0};
+    for(std::size_t i = 0; i < size; i++)
+        count += match.fails(a[i], b[i]) ? 1 : 0;
+    return count;
+}
+
+template<class Match, class T>
+std::size_t
+count_failures(const Match& match, const T* a, const T* b, std::size_t size)
+{
+    return count_failures_scalar(match, a, b, size);
+}
+
+#ifdef CORGI_TEST_HAS_SSE2
+
+inline std::size_t popcount(unsigned mask)
+{
+    std::size_t count {0};
+    for(; mask != 0; mask &= mask - 1)
+        count++;
+    return count;
+}
+
+/*!
+ * @brief Runs @p kernel on every full vector of @p size elements, and
+ * counts the tail one element at a time
+ *
+ * @param kernel    Returns the movemask of the lanes that don't match
+ */
+template<std::size_t Lanes, class Match, class T, class Kernel>
+std::size_t count_lanes(const Match& match,
+                        const T*     a,
+                        const T*     b,
+                        std::size_t  size,
+                        Kernel&&     kernel)
+{
+    std::size_t count {0};
+    std::size_t i {0};
+
+    for(; i + Lanes <= size; i += Lanes)
+        count += popcount(static_cast<unsigned>(kernel(a + i, b + i)));
+
+    return count + count_failures_scalar(match, a + i, b + i, size - i);
+}
+
+inline std::size_t count_failures(const exact_match& match,
+                                  const float*       a,
+                                  const float*       b,
+                                  std::size_t        size)
+{
+    return count_lanes<4>(match, a, b, size,
+                          [](const float* x, const float* y)
+                          {
+                              return _mm_movemask_ps(_mm_cmpneq_ps(
+                                  _mm_loadu_ps(x), _mm_loadu_ps(y)));
+                          });
+}
+
+inline std::size_t count_failures(const exact_match& match,
+                                  const double*      a,
+                                  const double*      b,
+                                  std::size_t        size)
+{
+    return count_lanes<2>(match, a, b, size,
+                          [](const double* x, const double* y)
+                          {
+                              return _mm_movemask_pd(_mm_cmpneq_pd(
+                                  _mm_loadu_pd(x), _mm_loadu_pd(y)));
+                          });
+}
+
+inline std::size_t count_failures(const near_match& match,
+                                  const float*      a,
+                                  const float*      b,
+                                  std::size_t       size)
+{
+    const auto sign     = _mm_set1_ps(-0.0f);
+    const auto largest  = _mm_set1_ps(std::numeric_limits<float>::max());
+    const auto absolute = _mm_set1_ps(static_cast<float>(match.absolute));
+    const auto relative = _mm_set1_ps(static_cast<float>(match.relative));
+
+    return count_lanes<4>(
+        match, a, b, size,
+        [&](const float* x, const float* y)
+        {
+            const auto va        = _mm_loadu_ps(x);
+            const auto vb        = _mm_loadu_ps(y);
+            const auto magnitude = _mm_max_ps(_mm_andnot_ps(sign, va),
+                                              _mm_andnot_ps(sign, vb));
+            const auto tolerance =
+                _mm_max_ps(absolute, _mm_mul_ps(relative, magnitude));
+            const auto distance = _mm_andnot_ps(sign, _mm_sub_ps(va, vb));
+            const auto close    = _mm_and_ps(_mm_cmple_ps(distance, tolerance),
+                                             _mm_cmple_ps(distance, largest));
+            const auto passes   = _mm_or_ps(_mm_cmpeq_ps(va, vb), close);
+            return _mm_movemask_ps(passes) ^ 0xf;
+        });
+}
+
+inline std::size_t count_failures(const near_match& match,
+                                  const double*     a,
+                                  const double*     b,
+                                  std::size_t       size)
+{
+    const auto sign     = _mm_set1_pd(-0.0);
+    const auto largest  = _mm_set1_pd(std::numeric_limits<double>::max());
+    const auto absolute = _mm_set1_pd(match.absolute);
+    const auto relative = _mm_set1_pd(match.relative);
+
+    return count_lanes<2>(
+        match, a, b, size,
+        [&](const double* x, const double* y)
+        {
+            const auto va        = _mm_loadu_pd(x);
+            const auto vb        = _mm_loadu_pd(y);
+            const auto magnitude = _mm_max_pd(_mm_andnot_pd(sign, va),
+                                              _mm_andnot_pd(sign, vb));
+            const auto tolerance =
+                _mm_max_pd(absolute, _mm_mul_pd(relative, magnitude));
+            const auto distance = _mm_andnot_pd(sign, _mm_sub_pd(va, vb));
+            const auto close    = _mm_and_pd(_mm_cmple_pd(distance, tolerance),
+                                             _mm_cmple_pd(distance, largest));
+            const auto passes   = _mm_or_pd(_mm_cmpeq_pd(va, vb), close);
+            return _mm_movemask_pd(passes) ^ 0x3;
+        });
+}
+
+/*!
+ * @brief ULP distance of floats, on 32 bits lanes
+ *
+ * A difference that overflows is more than 2^31 values apart, so it fails
+ * like the scalar version, whose limit never goes above 2^31 - 1.
+ */
+inline std::size_t count_failures(const ulp_match& match,
+                                  const float*     a,
+                                  const float*     b,
+                                  std::size_t      size)
+{
+    const auto limit    = static_cast<std::int32_t>(match.limit<float>());
+    const auto maximum  = _mm_set1_epi32(limit);
+    const auto minimum  = _mm_set1_epi32(-limit);
+    const auto smallest = _mm_set1_epi32(std::numeric_limits<int>::min());
+
+    // Negative floats count down from 0
+    const auto ordered = [&](__m128i bits)
+    {
+        const auto negative = _mm_srai_epi32(bits, 31);
+        return _mm_or_si128(
+            _mm_and_si128(negative, _mm_sub_epi32(smallest, bits)),
+            _mm_andnot_si128(negative, bits));
+    };
+
+    return count_lanes<4>(
+        match, a, b, size,
+        [&](const float* x, const float* y)
+        {
+            const auto va = _mm_loadu_ps(x);
+            const auto vb = _mm_loadu_ps(y);
+            const auto ia = ordered(_mm_castps_si128(va));
+            const auto ib = ordered(_mm_castps_si128(vb));
+            const auto d  = _mm_sub_epi32(ia, ib);
+
+            const auto overflow = _mm_srai_epi32(
+                _mm_and_si128(_mm_xor_si128(ia, ib), _mm_xor_si128(ia, d)),
+                31);
+            const auto far = _mm_or_si128(_mm_cmpgt_epi32(d, maximum),
+                                          _mm_cmplt_epi32(d, minimum));
+            const auto nan = _mm_castps_si128(_mm_cmpunord_ps(va, vb));
+            const auto fails =
+                _mm_or_si128(_mm_or_si128(overflow, far), nan);
+            return _mm_movemask_ps(_mm_castsi128_ps(fails));
+        });
+}
+
+#endif
+
+/*!
+ * @brief Compares @p a and @p b element by element
+ *
+ * The ranges are compared in blocks. A block is first only counted, with the
+ * vectorized kernel when there's one, and only looked at element by element
+ * when it has a mismatch whose index must be kept.
+ */
+template<class Match, class T>
+range_mismatches
+compare_ranges(const Match& match, const T* a, const T* b, std::size_t size)
+{
+    constexpr std::size_t block = 1024;
+
+    range_mismatches result;
+    std::size_t      kept {0};
+
+    for(std::size_t begin = 0; begin < size; begin += block)
+    {
+        const auto length = std::min(block, size - begin);
+        const auto found  = count_failures(match, a + begin, b + begin, length);
+
+        if(found == 0)
+            continue;
+
+        result.count += found;
+
+        for(std::size_t i = begin;
+            i < begin + length && kept < range_mismatches::kept; i++)
+            if(match.fails(a[i], b[i]))
+                result.indices[kept++] = i;
+    }
+    return result;
+}
+}    // namespace detail
+}    // namespace test
+}    // namespace corgi
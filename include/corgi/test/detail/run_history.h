@@ -0,0 +1,212 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace corgi
+{
+namespace test
+{
+namespace detail
+{
+/*!
+ * @brief How a test went the last time it ran
+ */
+struct test_history
+{
+    long long time {0};    // Microseconds
+    bool      failed {false};
+};
+
+/*!
+ * @brief Duration and outcome of every test, kept from one run to the next
+ *
+ * Tests are known by their full name, "group.name". A run only updates the
+ * tests it ran, so filtering a run doesn't forget about the other tests.
+ */
+class run_history
+{
+public:
+    /*!
+     * @brief How @p name went the last time it ran, or nullptr if it never
+     * did
+     */
+    const test_history* find(std::string_view name) const
+    {
+        const auto it = _tests.find(name);
+        return it == _tests.end() ? nullptr : &it->second;
+    }
+
+    void record(std::string name, long long time, bool failed)
+    {
+        _tests[std::move(name)] = test_history {time, failed};
+    }
+
+    bool empty() const { return _tests.empty(); }
+
+    void clear() { _tests.clear(); }
+
+    /*!
+     * @brief Writes one line per test : its name, time and outcome, separated
+     * by tabulations
+     */
+    void write(std::FILE* file) const
+    {
+        std::string text = "# corgi-test run history, time in microseconds\n";
+
+        for(const auto& [name, test] : _tests)
+            text += name + '\t' + std::to_string(test.time) + '\t' +
+                    (test.failed ? "failed" : "passed") + '\n';
+
+        std::fwrite(text.data(), 1, text.size(), file);
+        std::fflush(file);
+    }
+
+    /*!
+     * @brief Adds what @ref write wrote to the history
+     *
+     * Throws std::runtime_error if a line isn't made of a name, a time and
+     * an outcome
+     */
+    void read(std::FILE* file)
+    {
+        std::string line;
+        int         c {0};
+
+        do
+        {
+            c = std::fgetc(file);
+
+            if(c != EOF && c != '\n')
+            {
+                line += static_cast<char>(c);
+                continue;
+            }
+
+            if(!line.empty() && line[0] != '#')
+                read_line(line);
+            line.clear();
+        } while(c != EOF);
+    }
+
+private:
+    void read_line(const std::string& line)
+    {
+        const auto outcome = line.rfind('\t');
+        const auto time    = outcome == std::string::npos || outcome == 0 ?
+                                 std::string::npos :
+                                 line.rfind('\t', outcome - 1);
+
+        if(time == std::string::npos)
+            throw std::runtime_error("Invalid history line : " + line);
+
+        const auto result = std::string_view(line).substr(outcome + 1);
+        char*      end {nullptr};
+        const auto microseconds =
+            std::strtoll(line.c_str() + time + 1, &end, 10);
+
+        if(end != line.c_str() + outcome || end == line.c_str() + time + 1 ||
+           (result != "passed" && result != "failed"))
+            throw std::runtime_error("Invalid history line : " + line);
+
+        record(line.substr(0, time), microseconds, result == "failed");
+    }
+
+    std::map<std::string, test_history, std::less<>> _tests;
+};
+
+/*!
+ * @brief Order in which @p count tasks should be handed to workers, so the
+ * longest start first
+ *
+ * Starting the longest tasks first keeps a long one from being picked up
+ * last, while every other worker has nothing left to do. Tasks that never ran
+ * could be long too, so they come first, in their original order.
+ *
+ * @param time  Returns the last duration of a task, or a negative value if
+ *              it never ran
+ */
+template<class Time>
+std::vector<std::size_t> longest_first(std::size_t count, Time&& time)
+{
+    std::vector<std::size_t> order(count);
+    std::vector<long long>   times(count);
+
+    for(std::size_t i = 0; i < count; i++)
+    {
+        order[i] = i;
+        times[i] = time(i);
+    }
+
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t a, std::size_t b)
+                     {
+                         if(times[a] < 0 || times[b] < 0)
+                             return times[a] < 0 && times[b] >= 0;
+                         return times[a] > times[b];
+                     });
+    return order;
+}
+
+/*!
+ * @brief FNV-1a hash of @p text, the same on every platform and every run,
+ * unlike std::hash
+ */
+inline std::uint64_t stable_hash(std::string_view text)
+{
+    std::uint64_t hash {14695981039346656037ull};
+
+    for(const char c : text)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/*!
+ * @brief Deals tasks lasting @p times between @p count shards, so every
+ * shard takes about as long
+ *
+ * Tasks are taken longest first, and every one goes to the shard that has
+ * the least to do so far, the first one on ties. The result only depends on
+ * @p times, so every machine computing it gets the same shards.
+ *
+ * @return The shard of every task
+ */
+inline std::vector<std::size_t>
+balance_shards(const std::vector<long long>& times, std::size_t count)
+{
+    std::vector<std::size_t> order(times.size());
+    for(std::size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t a, std::size_t b)
+                     { return times[a] > times[b]; });
+
+    std::vector<long long>   loads(count, 0);
+    std::vector<std::size_t> shards(times.size());
+
+    for(auto task : order)
+    {
+        const auto lightest = static_cast<std::size_t>(
+            std::min_element(loads.begin(), loads.end()) - loads.begin());
+
+        shards[task] = lightest;
+        loads[lightest] += times[task];
+    }
+    return shards;
+}
+}    // namespace detail
+}    // namespace test
+}    // namespace corgi
@@ -0,0 +1,310 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace corgi
+{
+namespace test
+{
+namespace detail
+{
+/*!
+ * @brief Summary of a set of measures
+ */
+struct sample_statistics
+{
+    double      min {0.0};
+    double      max {0.0};
+    double      mean {0.0};
+    double      median {0.0};
+    double      p90 {0.0};
+    double      p99 {0.0};
+    double      stddev {0.0};
+    double      mad {0.0};    // Median absolute deviation
+    std::size_t outliers {0};
+};
+
+/*!
+ * @brief Value below which @p p percent of @p sorted falls, interpolated
+ * between the two closest measures
+ */
+inline double percentile(const std::vector<double>& sorted, double p)
+{
+    if(sorted.empty())
+        return 0.0;
+
+    const double rank  = p / 100.0 * static_cast<double>(sorted.size() - 1);
+    const auto   lower = static_cast<std::size_t>(rank);
+    const auto   upper = std::min(lower + 1, sorted.size() - 1);
+
+    return sorted[lower] +
+           (sorted[upper] - sorted[lower]) * (rank - static_cast<double>(lower));
+}
+
+inline double median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    return percentile(values, 50.0);
+}
+
+/*!
+ * @brief Computes the summary of @p samples
+ *
+ * A sample is an outlier when its modified z-score, based on the median and
+ * the median absolute deviation, is above 3.5. Unlike the standard deviation,
+ * these aren't dragged around by the outliers themselves.
+ */
+inline sample_statistics compute_statistics(std::vector<double> samples)
+{
+    sample_statistics result;
+
+    if(samples.empty())
+        return result;
+
+    std::sort(samples.begin(), samples.end());
+
+    const auto count = static_cast<double>(samples.size());
+    double     sum {0.0};
+
+    for(const auto sample : samples)
+        sum += sample;
+
+    result.min    = samples.front();
+    result.max    = samples.back();
+    result.mean   = sum / count;
+    result.median = percentile(samples, 50.0);
+    result.p90    = percentile(samples, 90.0);
+    result.p99    = percentile(samples, 99.0);
+
+    double              squares {0.0};
+    std::vector<double> deviations;
+    deviations.reserve(samples.size());
+
+    for(const auto sample : samples)
+    {
+        squares += (sample - result.mean) * (sample - result.mean);
+        deviations.push_back(std::abs(sample - result.median));
+    }
+
+    if(samples.size() > 1)
+        result.stddev = std::sqrt(squares / (count - 1.0));
+
+    result.mad = median(std::move(deviations));
+
+    if(result.mad > 0.0)
+    {
+        for(const auto sample : samples)
+            if(0.6745 * std::abs(sample - result.median) / result.mad > 3.5)
+                result.outliers++;
+    }
+    return result;
+}
+
+/*!
+ * @brief Ratio between two medians, with its confidence interval
+ */
+struct ratio_interval
+{
+    double ratio {1.0};
+    double lower {1.0};
+    double upper {1.0};
+
+    /*!
+     * @brief Whether the ratio is different from 1 with the requested
+     * confidence
+     */
+    bool significant() const { return lower > 1.0 || upper < 1.0; }
+};
+
+/*!
+ * @brief Estimates how many times the median of @p numerator is bigger than
+ * the median of @p denominator
+ *
+ * The confidence interval comes from a bootstrap : both sets of samples are
+ * resampled with replacement @p resamples times, and the interval holds the
+ * central @p confidence part of the ratios obtained. The generator uses a
+ * fixed seed so that the same samples always give the same interval.
+ */
+inline ratio_interval
+bootstrap_median_ratio(const std::vector<double>& numerator,
+                       const std::vector<double>& denominator,
+                       double                     confidence = 0.95,
+                       std::size_t                resamples  = 2000)
+{
+    ratio_interval result;
+
+    if(numerator.empty() || denominator.empty())
+        return result;
+
+    const double bottom = median(denominator);
+    if(bottom <= 0.0)
+        return result;
+
+    result.ratio = median(numerator) / bottom;
+
+    std::mt19937_64     generator(0x5eed);
+    std::vector<double> ratios;
+    std::vector<double> a(numerator.size());
+    std::vector<double> b(denominator.size());
+    ratios.reserve(resamples);
+
+    auto resample = [&](const std::vector<double>& from,
+                        std::vector<double>&       to)
+    {
+        std::uniform_int_distribution<std::size_t> pick(0, from.size() - 1);
+        for(auto& value : to)
+            value = from[pick(generator)];
+        std::sort(to.begin(), to.end());
+        return percentile(to, 50.0);
+    };
+
+    for(std::size_t i = 0; i < resamples; i++)
+    {
+        const double top   = resample(numerator, a);
+        const double under = resample(denominator, b);
+
+        if(under > 0.0)
+            ratios.push_back(top / under);
+    }
+
+    if(ratios.empty())
+        return result;
+
+    std::sort(ratios.begin(), ratios.end());
+    result.lower = percentile(ratios, 50.0 * (1.0 - confidence));
+    result.upper = percentile(ratios, 100.0 - 50.0 * (1.0 - confidence));
+    return result;
+}
+/*!
+ * @brief Growth rates a benchmark over a range of sizes can be fitted to
+ */
+enum class complexity
+{
+    constant,
+    logarithmic,
+    linear,
+    linearithmic,
+    quadratic
+};
+
+inline const char* to_string(complexity big_o)
+{
+    switch(big_o)
+    {
+        case complexity::constant:
+            return "O(1)";
+        case complexity::logarithmic:
+            return "O(log n)";
+        case complexity::linear:
+            return "O(n)";
+        case complexity::linearithmic:
+            return "O(n log n)";
+        case complexity::quadratic:
+            return "O(n^2)";
+    }
+    return "O(?)";
+}
+
+/*!
+ * @brief Value of the function behind @p big_o for a size of @p n
+ */
+inline double complexity_term(complexity big_o, double n)
+{
+    switch(big_o)
+    {
+        case complexity::constant:
+            return 1.0;
+        case complexity::logarithmic:
+            return std::log2(n);
+        case complexity::linear:
+            return n;
+        case complexity::linearithmic:
+            return n * std::log2(n);
+        case complexity::quadratic:
+            return n * n;
+    }
+    return 1.0;
+}
+
+/*!
+ * @brief Complexity that explains a set of measures the best
+ */
+struct complexity_fit
+{
+    complexity big_o {complexity::constant};
+    double     coefficient {0.0};    // time = coefficient * term(n)
+
+    /*!
+     * @brief Root mean square of the errors of the fit, relative to the mean
+     * time. The smaller, the better the fit
+     */
+    double rms {0.0};
+};
+
+/*!
+ * @brief Fits @p times, measured for every size of @p sizes, to every
+ * complexity, and keeps the one with the smallest error
+ *
+ * Every fit is a least square fit of time = coefficient * term(n), whose
+ * coefficient is sum(time * term) / sum(term * term). On a tie, the slowest
+ * growing complexity wins.
+ */
+inline complexity_fit fit_complexity(const std::vector<double>& sizes,
+                                     const std::vector<double>& times)
+{
+    complexity_fit best;
+
+    if(sizes.empty() || sizes.size() != times.size())
+        return best;
+
+    double mean {0.0};
+    for(const auto time : times)
+        mean += time;
+    mean /= static_cast<double>(times.size());
+
+    best.rms = std::numeric_limits<double>::infinity();
+
+    for(const auto big_o :
+        {complexity::constant, complexity::logarithmic, complexity::linear,
+         complexity::linearithmic, complexity::quadratic})
+    {
+        double products {0.0};
+        double squares {0.0};
+
+        for(std::size_t i = 0; i < sizes.size(); i++)
+        {
+            const double term = complexity_term(big_o, sizes[i]);
+            products += times[i] * term;
+            squares += term * term;
+        }
+
+        if(squares <= 0.0)
+            continue;
+
+        const double coefficient = products / squares;
+        double       errors {0.0};
+
+        for(std::size_t i = 0; i < sizes.size(); i++)
+        {
+            const double error =
+                times[i] - coefficient * complexity_term(big_o, sizes[i]);
+            errors += error * error;
+        }
+
+        double rms = std::sqrt(errors / static_cast<double>(sizes.size()));
+        if(mean > 0.0)
+            rms /= mean;
+
+        if(rms < best.rms)
+            best = {big_o, coefficient, rms};
+    }
+    return best;
+}
+}    // namespace detail
+}    // namespace test
+}    // namespace corgi
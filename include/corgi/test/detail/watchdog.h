@@ -0,0 +1,144 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace corgi
+{
+namespace test
+{
+namespace detail
+{
+/*!
+ * @brief Watches running tasks from a background thread, and reports the
+ * ones lasting longer than their timeout
+ *
+ * Tasks can be watched from any thread. The thread sleeps until the closest
+ * deadline, so watching costs nothing while every task is on time. A task is
+ * only reported once, and keeps being watched until it is released.
+ */
+class watchdog
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    /*!
+     * @brief Called from the watchdog thread with the name of a task that
+     * timed out, and how long it has been running
+     */
+    using timeout_function =
+        std::function<void(const std::string&, std::chrono::milliseconds)>;
+
+    explicit watchdog(timeout_function on_timeout)
+        : _on_timeout(std::move(on_timeout))
+        , _thread([this]() { work(); })
+    {
+    }
+
+    watchdog(const watchdog&)            = delete;
+    watchdog& operator=(const watchdog&) = delete;
+
+    ~watchdog()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wake.notify_one();
+        _thread.join();
+    }
+
+    /*!
+     * @brief Starts watching a task called @p name
+     * @return What @ref release needs once the task is done
+     */
+    std::size_t watch(std::string name, std::chrono::milliseconds timeout)
+    {
+        std::size_t id {0};
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            id = ++_last_id;
+
+            const auto now = clock::now();
+            _tasks.emplace(id, task {std::move(name), now, now + timeout});
+        }
+        _wake.notify_one();
+        return id;
+    }
+
+    void release(std::size_t id)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tasks.erase(id);
+    }
+
+private:
+    struct task
+    {
+        std::string       name;
+        clock::time_point start;
+        clock::time_point deadline;
+        bool              reported {false};
+    };
+
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        while(!_stop)
+        {
+            auto next = clock::time_point::max();
+            for(const auto& [id, task] : _tasks)
+                if(!task.reported && task.deadline < next)
+                    next = task.deadline;
+
+            if(next == clock::time_point::max())
+            {
+                _wake.wait(lock);
+                continue;
+            }
+
+            if(clock::now() < next)
+            {
+                _wake.wait_until(lock, next);
+                continue;
+            }
+
+            for(auto& [id, task] : _tasks)
+            {
+                const auto now = clock::now();
+                if(task.reported || now < task.deadline)
+                    continue;
+
+                task.reported = true;
+
+                const auto name    = task.name;
+                const auto elapsed = std::chrono::duration_cast<
+                    std::chrono::milliseconds>(now - task.start);
+
+                // The task may be released meanwhile, so the loop restarts
+                lock.unlock();
+                _on_timeout(name, elapsed);
+                lock.lock();
+                break;
+            }
+        }
+    }
+
+    timeout_function            _on_timeout;
+    std::mutex                  _mutex;
+    std::condition_variable     _wake;
+    std::map<std::size_t, task> _tasks;
+    std::size_t                 _last_id {0};
+    bool                        _stop {false};
+    std::thread                 _thread;    // Last, starts once all is set
+};
+}    // namespace detail
+}    // namespace test
+}    // namespace corgi
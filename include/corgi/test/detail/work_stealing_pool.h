@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace corgi
+{
+namespace test
+{
+namespace detail
+{
+/*!
+ * @brief Runs a fixed set of indexed tasks on a pool of worker threads
+ *
+ * Every worker owns a queue of task indices. A worker takes its own tasks from
+ * the front of its queue, and once it is empty, steals from the back of the
+ * other workers' queues. Tasks are dealt round robin in the order they are
+ * given, so the first tasks are also the first ones to be picked up.
+ *
+ * The pool starts working as soon as it is constructed, and is only meant to
+ * run one batch of tasks. Call @ref join to wait for every task to be done.
+ */
+class work_stealing_pool
+{
+public:
+    using task_function = std::function<void(std::size_t)>;
+
+    /*!
+     * @param worker_count  How many threads will run the tasks
+     * @param tasks         Indices given to @p function, in the order they
+     *                      should be picked up
+     * @param function      Called once for every index inside @p tasks
+     */
+    work_stealing_pool(std::size_t                     worker_count,
+                       const std::vector<std::size_t>& tasks,
+                       task_function                   function)
+        : _function(std::move(function))
+    {
+        if(worker_count == 0)
+            worker_count = 1;
+
+        _queues.reserve(worker_count);
+        for(std::size_t i = 0; i < worker_count; i++)
+            _queues.push_back(std::make_unique<queue>());
+
+        for(std::size_t i = 0; i < tasks.size(); i++)
+            _queues[i % worker_count]->tasks.push_back(tasks[i]);
+
+        _threads.reserve(worker_count);
+        for(std::size_t i = 0; i < worker_count; i++)
+            _threads.emplace_back([this, i]() { work(i); });
+    }
+
+    work_stealing_pool(const work_stealing_pool&)            = delete;
+    work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+    ~work_stealing_pool() { join(); }
+
+    /*!
+     * @brief Blocks until every task has been run
+     */
+    void join()
+    {
+        for(auto& thread : _threads)
+            if(thread.joinable())
+                thread.join();
+    }
+
+private:
+    struct queue
+    {
+        std::mutex              mutex;
+        std::deque<std::size_t> tasks;
+    };
+
+    bool pop(std::size_t worker, std::size_t& task)
+    {
+        auto&                       q = *_queues[worker];
+        std::lock_guard<std::mutex> lock(q.mutex);
+
+        if(q.tasks.empty())
+            return false;
+
+        task = q.tasks.front();
+        q.tasks.pop_front();
+        return true;
+    }
+
+    bool steal(std::size_t thief, std::size_t& task)
+    {
+        for(std::size_t i = 1; i < _queues.size(); i++)
+        {
+            auto& q = *_queues[(thief + i) % _queues.size()];
+
+            std::lock_guard<std::mutex> lock(q.mutex);
+
+            if(q.tasks.empty())
+                continue;
+
+            task = q.tasks.back();
+            q.tasks.pop_back();
+            return true;
+        }
+        return false;
+    }
+
+    // No task is ever added once the pool started, so a worker can leave as
+    // soon as it doesn't find anything to steal
+    void work(std::size_t worker)
+    {
+        std::size_t task {0};
+
+        while(pop(worker, task) || steal(worker, task))
+            _function(task);
+    }
+
+    task_function                       _function;
+    std::vector<std::unique_ptr<queue>> _queues;
+    std::vector<std::thread>            _threads;
+};
+}    // namespace detail
+}    // namespace test
+}    // namespace corgi
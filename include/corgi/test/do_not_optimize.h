@@ -0,0 +1,93 @@
+#pragma once
+
+#include <type_traits>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#    include <intrin.h>
+#endif
+
+namespace corgi
+{
+namespace test
+{
+/*
+ * Benchmarked code whose result is never used can legally be removed by the
+ * optimizer, and the benchmark then measures an empty loop. These barriers
+ * make the compiler believe a value is read, or that any memory may be
+ * accessed, without generating any instruction. Nothing changes at run time,
+ * which is why only the generated code can show what they do.
+ *
+ * @code
+ * [&]()
+ * {
+ *     auto value = compute(input);
+ *     corgi::test::do_not_optimize(value);    // Computed on every call
+ *
+ *     buffer[0] = value;
+ *     corgi::test::clobber_memory();    // Written on every call
+ * }
+ * @endcode
+ */
+
+#if defined(__GNUC__) || defined(__clang__)
+
+/*!
+ * @brief Forces @p value to be computed, as if something read it
+ */
+template<class T>
+inline void do_not_optimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/*!
+ * @brief Forces @p value to be computed, and makes the compiler assume it
+ * may have been modified, so it can't be hoisted out of a loop either
+ */
+template<class T>
+inline void do_not_optimize(T& value)
+{
+#    if defined(__clang__)
+    asm volatile("" : "+r,m"(value) : : "memory");
+#    else
+    if constexpr(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(T*))
+        asm volatile("" : "+m,r"(value) : : "memory");
+    else
+        asm volatile("" : "+m"(value) : : "memory");
+#    endif
+}
+
+/*!
+ * @brief Forces every pending write to memory to happen here
+ */
+inline void clobber_memory()
+{
+    asm volatile("" : : : "memory");
+}
+
+#else
+
+namespace detail
+{
+inline void escape(const volatile void* pointer)
+{
+    static const volatile void* volatile sink;
+    sink = pointer;
+}
+}    // namespace detail
+
+template<class T>
+inline void do_not_optimize(const T& value)
+{
+    detail::escape(&value);
+    _ReadWriteBarrier();
+}
+
+inline void clobber_memory()
+{
+    _ReadWriteBarrier();
+}
+
+#endif
+}    // namespace test
+}    // namespace corgi
@@ -0,0 +1,79 @@
+#pragma once
+
+// Registration and checks only, for test files that don't need anything else.
+//
+// Everything that writes reports or runs tests is compiled once, inside the
+// corgi-test-runtime library, instead of being parsed again by every test
+// file. A test file includes either this header or corgi/test/test.h, never
+// both, and both kinds of files can be linked into the same executable.
+
+#include <corgi/test/runtime.h>
+
+#define TEST(group_name, function_name) \
+    TAGGED_TEST(group_name, function_name, "")
+
+#define TAGGED_TEST(group_name, function_name, tags)                          \
+    void       group_name##_##function_name();                                \
+    static int var##group_name##function_name =                               \
+        corgi::test::runtime::register_test(&group_name##_##function_name,    \
+                                            #function_name, #group_name,      \
+                                            tags);                            \
+    void group_name##_##function_name()
+
+#define check_equals(value1, value2) \
+    corgi::test::runtime::check_equals_(value1, value2, __FILE__, __LINE__)
+
+#define check_non_equals(value1, value2)                                      \
+    corgi::test::runtime::check_non_equals_(value1, value2, __FILE__,         \
+                                            __LINE__)
+
+#define check_throw(statement, type)                                          \
+    {                                                                         \
+        bool has_thrown = false;                                              \
+        try                                                                   \
+        {                                                                     \
+            statement;                                                        \
+        }                                                                     \
+        catch(type&)                                                          \
+        {                                                                     \
+            has_thrown = true;                                                \
+        }                                                                     \
+        catch(...)                                                            \
+        {                                                                     \
+        }                                                                     \
+        if(!has_thrown)                                                       \
+            corgi::test::runtime::log_throw_error(__FILE__, __LINE__,         \
+                                                  "No exception was thrown"); \
+    }
+
+#define check_any_throw(statement)                                            \
+    {                                                                         \
+        bool has_thrown = false;                                              \
+        try                                                                   \
+        {                                                                     \
+            statement;                                                        \
+        }                                                                     \
+        catch(...)                                                            \
+        {                                                                     \
+            has_thrown = true;                                                \
+        }                                                                     \
+        if(!has_thrown)                                                       \
+            corgi::test::runtime::log_throw_error(__FILE__, __LINE__,         \
+                                                  "No exception was thrown"); \
+    }
+
+#define check_no_throw(statement)                                             \
+    {                                                                         \
+        bool has_thrown = false;                                              \
+        try                                                                   \
+        {                                                                     \
+            statement;                                                        \
+        }                                                                     \
+        catch(...)                                                            \
+        {                                                                     \
+            has_thrown = true;                                                \
+        }                                                                     \
+        if(has_thrown)                                                        \
+            corgi::test::runtime::log_throw_error(__FILE__, __LINE__,         \
+                                                  "An exception was thrown"); \
+    }
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <unistd.h>
+#endif
+
+namespace corgi
+{
+namespace test
+{
+/*!
+ * @brief Destination of everything the framework prints
+ *
+ * The runner gathers the output of a test inside a buffer, and hands it to
+ * the sink in one block once the test is done. A sink must never split nor
+ * interleave the blocks it receives.
+ */
+class output_sink
+{
+public:
+    virtual ~output_sink() = default;
+
+    /*!
+     * @brief Writes a block of text
+     */
+    virtual void write(std::string text) = 0;
+
+    /*!
+     * @brief Blocks until every block received so far has been written
+     */
+    virtual void flush() = 0;
+
+    /*!
+     * @brief Called when the process is crashing
+     *
+     * Must write whatever is still pending without taking any lock, since the
+     * crashing thread may already hold it. Best effort only.
+     */
+    virtual void emergency_flush() noexcept {}
+};
+
+/*!
+ * @brief Writes every block straight away on the calling thread
+ *
+ * Nothing is ever kept in memory, so nothing is lost if the process crashes
+ * right after a write. Used when asking for a synchronous output.
+ */
+class stream_sink : public output_sink
+{
+public:
+    explicit stream_sink(std::FILE* file = stdout)
+        : _file(file)
+    {
+    }
+
+    void write(std::string text) override
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::fwrite(text.data(), 1, text.size(), _file);
+        std::fflush(_file);
+    }
+
+    void flush() override
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::fflush(_file);
+    }
+
+private:
+    std::FILE* _file;
+    std::mutex _mutex;
+};
+
+/*!
+ * @brief Hands the blocks to a background thread that writes them
+ *
+ * Writing a block only costs a move into a queue for the caller. The writer
+ * thread takes everything queued at once and writes it with a single flush.
+ *
+ * The queue is a linked list the crash handler can walk without taking any
+ * lock. Writers append to it under the lock the writer thread waits on. A block stays in it until it was flushed, so a block the writer took
+ * but didn't flush yet is still written when crashing, at worst twice.
+ */
+class async_sink : public output_sink
+{
+public:
+    explicit async_sink(std::FILE* file = stdout)
+        : _file(file)
+        , _thread([this]() { work(); })
+    {
+    }
+
+    async_sink(const async_sink&)            = delete;
+    async_sink& operator=(const async_sink&) = delete;
+
+    ~async_sink() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wake_writer.notify_one();
+        _thread.join();
+
+        auto* head = _head.load(std::memory_order_relaxed);
+        while(head != nullptr)
+        {
+            auto* next = head->next.load(std::memory_order_relaxed);
+            if(head != &_stub)
+                delete head;
+            head = next;
+        }
+    }
+
+    void write(std::string text) override
+    {
+        auto* block = new node {std::move(text), {nullptr}};
+        {
+            // Linking and counting together, so the writer never counts a
+            // block that isn't linked yet
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tail->next.store(block, std::memory_order_release);
+            _tail = block;
+            _queued++;
+        }
+        _wake_writer.notify_one();
+    }
+
+    void flush() override
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _idle.wait(lock, [this]() { return _queued == 0 && !_writing; });
+    }
+
+    void emergency_flush() noexcept override
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        // Keeps the writer from freeing the blocks walked below
+        _crashing.store(true);
+
+        const auto* head = _head.load();
+        for(auto* block = head->next.load(std::memory_order_acquire);
+            block != nullptr;
+            block = block->next.load(std::memory_order_acquire))
+        {
+            const char* data = block->text.data();
+            auto        size = block->text.size();
+
+            while(size > 0)
+            {
+                const auto written = ::write(fileno(_file), data, size);
+                if(written <= 0)
+                    break;
+                data += written;
+                size -= static_cast<size_t>(written);
+            }
+        }
+#endif
+    }
+
+private:
+    struct node
+    {
+        std::string        text;
+        std::atomic<node*> next;
+    };
+
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        for(;;)
+        {
+            _wake_writer.wait(lock, [this]() { return _stop || _queued > 0; });
+
+            if(_queued == 0 && _stop)
+                return;
+
+            // Every counted block is linked, write() does both under the lock
+            const auto count = std::exchange(_queued, 0);
+            _writing         = true;
+            lock.unlock();
+
+            auto* block = _head.load(std::memory_order_relaxed);
+            for(size_t i = 0; i < count; i++)
+            {
+                block = block->next.load(std::memory_order_acquire);
+                std::fwrite(block->text.data(), 1, block->text.size(), _file);
+            }
+            std::fflush(_file);
+
+            // The last written block becomes the head the next ones hang from
+            for(size_t i = 0; i < count; i++)
+            {
+                auto* written = _head.load(std::memory_order_relaxed);
+                _head.store(written->next.load(std::memory_order_relaxed));
+
+                if(written != &_stub && !_crashing.load())
+                    delete written;
+            }
+
+            lock.lock();
+            _writing = false;
+            _idle.notify_all();
+        }
+    }
+
+    std::FILE*              _file;
+    std::mutex              _mutex;
+    std::condition_variable _wake_writer;
+    std::condition_variable _idle;
+    node                    _stub {{}, {nullptr}};
+    std::atomic<node*>      _head {&_stub};    // Last block flushed, or stub
+    node*                   _tail {&_stub};    // Last block queued
+    std::atomic<bool>       _crashing {false};
+    size_t                  _queued {0};    // Linked, not taken by the writer
+    bool                    _writing {false};
+    bool                    _stop {false};
+    std::thread             _thread;    // Last, so it starts once all is set
+};
+}    // namespace test
+}    // namespace corgi
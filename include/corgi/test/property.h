@@ -0,0 +1,544 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace corgi
+{
+namespace test
+{
+namespace detail
+{
+/*!
+ * @brief Next number of the SplitMix64 sequence starting at @p state
+ */
+inline std::uint64_t split_mix(std::uint64_t& state)
+{
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z               = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z               = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+/*!
+ * @brief Where generators take their randomness from
+ *
+ * Every value a property draws is built from a sequence of choices, integers
+ * between 0 and a maximum. Generators map the choice 0 to their simplest
+ * value, so a smaller choice always means a simpler value.
+ *
+ * A source either makes random choices and records them, or replays recorded
+ * ones. Shrinking a failing case then only means shrinking its choices, and
+ * works for any generator, even the ones users compose themselves.
+ */
+class choice_source
+{
+public:
+    /*!
+     * @brief Makes random choices, always the same ones for a given @p seed
+     */
+    explicit choice_source(std::uint64_t seed) : _state(seed), _random(true) {}
+
+    /*!
+     * @brief Replays @p choices. Choices past the end are 0
+     */
+    explicit choice_source(std::vector<std::uint64_t> choices)
+        : _choices(std::move(choices))
+        , _random(false)
+    {
+    }
+
+    /*!
+     * @brief Next choice, between 0 and @p max included
+     *
+     * Random choices are biased towards 0, @p max and small values, where
+     * bugs usually hide.
+     */
+    std::uint64_t draw(std::uint64_t max)
+    {
+        if(!_random)
+            return _next < _choices.size() ?
+                       std::min(_choices[_next++], max) :
+                       0;
+
+        std::uint64_t choice;
+        switch(split_mix(_state) % 16)
+        {
+            case 0: choice = 0; break;
+            case 1: choice = max; break;
+            case 2:
+            case 3: choice = bounded(std::min<std::uint64_t>(max, 16)); break;
+            default: choice = bounded(max);
+        }
+        _choices.push_back(choice);
+        return choice;
+    }
+
+    /*!
+     * @brief Choices made so far, or the ones being replayed
+     */
+    const std::vector<std::uint64_t>& choices() const { return _choices; }
+
+    /*!
+     * @brief Called with the description of every value drawn by the
+     * property, when set
+     */
+    std::function<void(const std::string&)> on_draw;
+
+private:
+    std::uint64_t bounded(std::uint64_t max)
+    {
+        const auto value = split_mix(_state);
+        return max == std::numeric_limits<std::uint64_t>::max() ?
+                   value :
+                   value % (max + 1);
+    }
+
+    std::vector<std::uint64_t> _choices;
+    std::size_t                _next {0};
+    std::uint64_t              _state {0};
+    bool                       _random;
+};
+
+/*!
+ * @brief Makes @p choices as small as possible while @p fails keeps
+ * returning true for them
+ *
+ * Chunks of choices are removed first, which removes whole elements from
+ * containers, then every choice is lowered towards 0. Both are repeated until
+ * nothing gets smaller, or @p max_attempts candidates were tried.
+ *
+ * @param fails     Runs the property with the given choices, and returns
+ *                  true if it still fails
+ * @param shrinks   Receives how many times a smaller failing case was found
+ */
+template<class Fails>
+std::vector<std::uint64_t> shrink(std::vector<std::uint64_t> choices,
+                                  Fails&&                    fails,
+                                  std::size_t                max_attempts,
+                                  std::size_t&               shrinks)
+{
+    std::size_t attempts {0};
+
+    const auto improves = [&](const std::vector<std::uint64_t>& candidate)
+    {
+        if(attempts >= max_attempts)
+            return false;
+
+        attempts++;
+        if(!fails(candidate))
+            return false;
+
+        shrinks++;
+        return true;
+    };
+
+    for(bool improved = true; improved && attempts < max_attempts;)
+    {
+        improved = false;
+
+        for(std::size_t size : {8, 4, 2, 1})
+            for(std::size_t i = 0; i + size <= choices.size();)
+            {
+                auto candidate = choices;
+                candidate.erase(candidate.begin() + i,
+                                candidate.begin() + i + size);
+
+                if(improves(candidate))
+                {
+                    choices  = std::move(candidate);
+                    improved = true;
+                }
+                else
+                    i++;
+            }
+
+        for(std::size_t i = 0; i < choices.size(); i++)
+        {
+            if(choices[i] == 0)
+                continue;
+
+            // Binary search of the smallest choice still failing, between a
+            // passing one and a failing one
+            auto          candidate = choices;
+            std::uint64_t passing {0};
+            std::uint64_t failing = choices[i];
+
+            candidate[i] = 0;
+            if(improves(candidate))
+                failing = 0;
+
+            while(failing - passing > 1 && attempts < max_attempts)
+            {
+                candidate[i] = passing + (failing - passing) / 2;
+                if(improves(candidate))
+                    failing = candidate[i];
+                else
+                    passing = candidate[i];
+            }
+
+            if(failing != choices[i])
+            {
+                choices[i] = failing;
+                improved   = true;
+            }
+        }
+    }
+    return choices;
+}
+
+template<class T, class = void>
+struct is_printable : std::false_type
+{
+};
+
+template<class T>
+struct is_printable<
+    T,
+    std::void_t<decltype(std::declval<std::ostream&>() << std::declval<T>())>>
+    : std::true_type
+{
+};
+
+template<class T, class = void>
+struct is_range : std::false_type
+{
+};
+
+template<class T>
+struct is_range<T,
+                std::void_t<decltype(std::begin(std::declval<const T&>())),
+                            decltype(std::end(std::declval<const T&>()))>>
+    : std::true_type
+{
+};
+
+template<class T>
+struct is_tuple : std::false_type
+{
+};
+
+template<class... T>
+struct is_tuple<std::tuple<T...>> : std::true_type
+{
+};
+
+template<class T, class U>
+struct is_tuple<std::pair<T, U>> : std::true_type
+{
+};
+
+/*!
+ * @brief Writes a value drawn by a property, to show a counterexample
+ */
+template<class T>
+std::string describe(const T& value)
+{
+    if constexpr(std::is_same_v<T, bool>)
+        return value ? "true" : "false";
+    else if constexpr(std::is_convertible_v<const T&, std::string_view>)
+        return '"' + std::string(std::string_view(value)) + '"';
+    else if constexpr(is_tuple<T>::value)
+    {
+        std::string text;
+        const auto add = [&](const auto& element)
+        { text += (text.empty() ? "(" : ", ") + describe(element); };
+
+        std::apply([&](const auto&... element) { (add(element), ...); }, value);
+        return text.empty() ? "()" : text + ")";
+    }
+    else if constexpr(is_range<T>::value)
+    {
+        std::string text;
+        for(const auto& element : value)
+            text += (text.empty() ? "{" : ", ") + describe(element);
+        return text.empty() ? "{}" : text + "}";
+    }
+    else if constexpr(is_printable<T>::value)
+    {
+        std::ostringstream stream;
+        if constexpr(std::is_floating_point_v<T>)
+            stream.precision(std::numeric_limits<T>::max_digits10);
+        stream << value;
+        return stream.str();
+    }
+    else
+        return "(not printable)";
+}
+}    // namespace detail
+
+/*!
+ * @brief Generators of property inputs
+ *
+ * A generator is any object called with a detail::choice_source&, which
+ * returns a value built from the choices it draws. Generators are composed by
+ * calling one from another.
+ */
+namespace gen
+{
+/*!
+ * @brief Integers between @p min and @p max included, shrinking towards the
+ * one closest to 0
+ */
+template<class T>
+struct integers
+{
+    static_assert(std::is_integral_v<T>, "integers needs an integral type");
+
+    explicit integers(T min = std::numeric_limits<T>::lowest(),
+                      T max = std::numeric_limits<T>::max())
+        : min(min)
+        , max(max)
+    {
+        if(min > max)
+            throw std::invalid_argument("integers : min is greater than max");
+    }
+
+    /*!
+     * @brief Choices go back and forth around the origin : 0 is the origin,
+     * then origin + 1, origin - 1, origin + 2... Once a side is exhausted,
+     * they only go to the other one
+     */
+    T operator()(detail::choice_source& source) const
+    {
+        using bits = std::uint64_t;
+
+        const T    origin = std::clamp(T(0), min, max);
+        const bits up     = static_cast<bits>(max) - static_cast<bits>(origin);
+        const bits down   = static_cast<bits>(origin) - static_cast<bits>(min);
+        const bits both   = std::min(up, down);
+        const bits choice = source.draw(up + down);
+
+        bits offset;
+        bool below;
+
+        if(choice <= 2 * both)
+        {
+            offset = (choice + 1) / 2;
+            below  = choice != 0 && choice % 2 == 0;
+        }
+        else
+        {
+            offset = choice - both;
+            below  = down > up;
+        }
+
+        return static_cast<T>(below ? static_cast<bits>(origin) - offset :
+                                      static_cast<bits>(origin) + offset);
+    }
+
+    T min;
+    T max;
+};
+
+/*!
+ * @brief Finite floating point numbers between @p min and @p max, shrinking
+ * towards the one closest to 0
+ */
+template<class T>
+struct reals
+{
+    static_assert(std::is_floating_point_v<T>,
+                  "reals needs a floating point type");
+
+    explicit reals(T min = std::numeric_limits<T>::lowest(),
+                   T max = std::numeric_limits<T>::max())
+        : min(min)
+        , max(max)
+    {
+        if(!(min <= max))
+            throw std::invalid_argument("reals : min is greater than max");
+    }
+
+    T operator()(detail::choice_source& source) const
+    {
+        constexpr std::uint64_t steps = std::uint64_t(1) << 53;
+
+        const T    origin = std::clamp(T(0), min, max);
+        const bool side   = source.draw(1) != 0;
+        const bool below  = side ? origin > min : !(max > origin);
+        const auto step   = static_cast<double>(source.draw(steps));
+        const T    ratio  = static_cast<T>(step / static_cast<double>(steps));
+
+        const T value = below ? origin - ratio * (origin - min) :
+                                origin + ratio * (max - origin);
+        return std::clamp(value, min, max);
+    }
+
+    T min;
+    T max;
+};
+
+/*!
+ * @brief true or false, shrinking towards false
+ */
+struct booleans
+{
+    bool operator()(detail::choice_source& source) const
+    {
+        return source.draw(1) != 0;
+    }
+};
+
+/*!
+ * @brief One of @p values, shrinking towards the first one
+ */
+template<class T>
+struct element_of
+{
+    explicit element_of(std::vector<T> values) : values(std::move(values))
+    {
+        if(this->values.empty())
+            throw std::invalid_argument("element_of : no value to pick from");
+    }
+
+    const T& operator()(detail::choice_source& source) const
+    {
+        return values[source.draw(values.size() - 1)];
+    }
+
+    std::vector<T> values;
+};
+
+/*!
+ * @brief Vectors of at most @p max_size elements made by @p element,
+ * shrinking towards fewer and simpler elements
+ *
+ * Every element is preceded by a choice telling if there's one more, so
+ * removing that choice and the element's removes the element.
+ */
+template<class Generator>
+struct vectors
+{
+    using value_type = std::decay_t<decltype(std::declval<const Generator&>()(
+        std::declval<detail::choice_source&>()))>;
+
+    explicit vectors(Generator element, std::size_t max_size = 64)
+        : element(std::move(element))
+        , max_size(max_size)
+    {
+    }
+
+    std::vector<value_type> operator()(detail::choice_source& source) const
+    {
+        std::vector<value_type> result;
+        while(result.size() < max_size && source.draw(7) != 0)
+            result.push_back(element(source));
+        return result;
+    }
+
+    Generator   element;
+    std::size_t max_size;
+};
+
+/*!
+ * @brief Strings of at most @p max_size characters made by @p character,
+ * printable ASCII characters by default
+ */
+template<class Generator = integers<char>>
+struct strings
+{
+    explicit strings(std::size_t max_size  = 32,
+                     Generator   character = Generator(' ', '~'))
+        : characters(std::move(character), max_size)
+    {
+    }
+
+    std::string operator()(detail::choice_source& source) const
+    {
+        const auto letters = characters(source);
+        return std::string(letters.begin(), letters.end());
+    }
+
+    vectors<Generator> characters;
+};
+
+/*!
+ * @brief Values of @p generator passed through @p function
+ */
+template<class Generator, class Function>
+struct mapped
+{
+    auto operator()(detail::choice_source& source) const
+    {
+        return function(generator(source));
+    }
+
+    Generator generator;
+    Function  function;
+};
+
+template<class Generator, class Function>
+mapped<Generator, Function> map(Generator generator, Function function)
+{
+    return {std::move(generator), std::move(function)};
+}
+
+/*!
+ * @brief Tuples holding one value of every generator
+ */
+template<class... Generators>
+struct tuples
+{
+    explicit tuples(Generators... generators)
+        : generators(std::move(generators)...)
+    {
+    }
+
+    auto operator()(detail::choice_source& source) const
+    {
+        // Braced initialization runs the generators from left to right
+        return std::apply(
+            [&](const auto&... generator)
+            {
+                using tuple =
+                    std::tuple<std::decay_t<decltype(generator(source))>...>;
+                return tuple {generator(source)...};
+            },
+            generators);
+    }
+
+    std::tuple<Generators...> generators;
+};
+}    // namespace gen
+
+namespace detail
+{
+/*!
+ * @brief Source of the property case running on the current thread, if any
+ */
+inline thread_local choice_source* current_source {nullptr};
+}    // namespace detail
+
+/*!
+ * @brief Draws a value from @p generator, inside a PROPERTY
+ *
+ * Must be called from the thread running the property. Throws
+ * std::logic_error anywhere else
+ */
+template<class Generator>
+auto draw(const Generator& generator)
+{
+    auto* source = detail::current_source;
+    if(source == nullptr)
+        throw std::logic_error("draw can only be called inside a PROPERTY");
+
+    auto value = generator(*source);
+    if(source->on_draw)
+        source->on_draw(detail::describe(value));
+    return value;
+}
+}    // namespace test
+}    // namespace corgi
@@ -0,0 +1,83 @@
+#pragma once
+
+// Entry points of the corgi-test-runtime library, compiled once with
+// corgi/test/test.h. See corgi/test/light.h
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace corgi
+{
+namespace test
+{
+namespace runtime
+{
+int register_test(void (*function)(),
+                  std::string_view name,
+                  std::string_view group,
+                  std::string_view tags);
+
+/*!
+ * @brief Same as corgi::test::run_all
+ */
+int run_all(int argc, char** argv);
+
+/*!
+ * @brief True if a failure at @p file and @p line must only be counted
+ */
+bool silence_failure(const char* file, int line);
+
+void log_comparison_error(const char*        check,
+                          const std::string& val1,
+                          const std::string& val2,
+                          const char*        file,
+                          int                line);
+
+void log_throw_error(const char* file, int line, const char* what);
+
+/*!
+ * @brief Writes @p value without <sstream>. Types that aren't a number, a
+ * string, an enum or a pointer need corgi/test/test.h to be shown
+ */
+template<class T>
+std::string format_value(const T& value)
+{
+    if constexpr(std::is_same_v<T, bool>)
+        return value ? "true" : "false";
+    else if constexpr(std::is_same_v<T, char>)
+        return std::string(1, value);
+    else if constexpr(std::is_arithmetic_v<T>)
+        return std::to_string(value);
+    else if constexpr(std::is_enum_v<T>)
+        return std::to_string(static_cast<std::underlying_type_t<T>>(value));
+    else if constexpr(std::is_convertible_v<const T&, std::string_view>)
+        return std::string(std::string_view(value));
+    else if constexpr(std::is_pointer_v<T>)
+        return std::to_string(reinterpret_cast<std::uintptr_t>(value));
+    else
+        return "(not shown by corgi/test/light.h)";
+}
+
+template<class T>
+void check_equals_(const T& val1, const T& val2, const char* file, int line)
+{
+    if(val1 != val2 && !silence_failure(file, line))
+        log_comparison_error("equals", format_value(val1), format_value(val2),
+                             file, line);
+}
+
+template<class T>
+void check_non_equals_(const T&    val1,
+                       const T&    val2,
+                       const char* file,
+                       int         line)
+{
+    if(val1 == val2 && !silence_failure(file, line))
+        log_comparison_error("non equals", format_value(val1),
+                             format_value(val2), file, line);
+}
+}    // namespace runtime
+}    // namespace test
+}    // namespace corgi
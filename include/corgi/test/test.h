@@ -1,15 +1,57 @@
 #pragma once
 
+#include <corgi/test/allocations.h>
+#include <corgi/test/async.h>
+#include <corgi/test/detail/perf_counters.h>
+#include <corgi/test/detail/range_compare.h>
+#include <corgi/test/detail/run_history.h>
+#include <corgi/test/detail/statistics.h>
+#include <corgi/test/detail/watchdog.h>
+#include <corgi/test/detail/work_stealing_pool.h>
+#include <corgi/test/do_not_optimize.h>
+#include <corgi/test/output_sink.h>
+#include <corgi/test/property.h>
+
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
 #include <ctime>
+#include <deque>
 #include <functional>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#if defined(__unix__) || defined(__APPLE__)
+#    define CORGI_TEST_HAS_FORK 1
+#    include <cerrno>
+#    include <csignal>
+#    include <cstring>
+#    include <poll.h>
+#    include <sys/wait.h>
+#    include <unistd.h>
+#endif
+
 /*!
  * @brief      Provides a framework to make test driven development easier
  * @details    Use the TEST macro to define your testing functions.
@@ -37,9 +79,11 @@ using string = std::string;
 
 namespace detail
 {
-inline void log_failed_functions();
-template<class T>
-inline int register_fixture(const string& class_name, const string& test_name);
+struct test_case;
+struct test_result;
+inline void run_test(const test_case& test,
+                     test_result&     result,
+                     bool             alone = false);
 }    // namespace detail
 
 /*!
@@ -47,12 +91,9 @@ inline int register_fixture(const string& class_name, const string& test_name);
  */
 class Test
 {
-    friend void detail::log_failed_functions();
-    template<class T>
-    friend int detail::register_fixture(const string& class_name,
-                                        const string& test_name);
-
-    friend void run_fixtures();
+    friend void detail::run_test(const detail::test_case& test,
+                                 detail::test_result&     result,
+                                 bool                     alone);
 
 public:
     /*!
@@ -67,86 +108,263 @@ public:
     virtual ~Test() = default;
 
 private:
-    string _class_name;
-    string _test_name;
-
     /*!
      * @brief Overriden by the TEST_F macro
      */
     virtual void run() {}
 };
 
+/*!
+ * @brief How a matcher keeps its operand
+ *
+ * Scalars and arrays, as pointers, are copied. Anything else is only
+ * referenced, so a matcher never allocates nor copies a container or a
+ * string. A matcher must then be used inside the expression that builds it,
+ * like assert_that(x, equals(y)).
+ */
+template<class T>
+using matcher_operand =
+    std::conditional_t<std::is_scalar_v<std::decay_t<const T>>,
+                       std::decay_t<const T>,
+                       const T&>;
+
 template<class T>
 class Equals
 {
 public:
-    Equals(const T vv1)
-        : _val1(vv1)
+    constexpr explicit Equals(const T& value)
+        : _value(value)
     {
     }
 
     template<class U>
-    bool run(U val2)
+    constexpr bool run(const U& value) const
     {
-        return this->_val1 == val2;
+        return _value == value;
     }
 
-    T _val1;
+private:
+    matcher_operand<T> _value;
 };
 
 template<class T>
 class NonEquals
 {
 public:
-    NonEquals(T v1)
-        : _val1(v1)
+    constexpr explicit NonEquals(const T& value)
+        : _value(value)
     {
     }
 
     template<class U>
-    bool run(U val2)
+    constexpr bool run(const U& value) const
     {
-        return this->_val1 != val2;
+        return _value != value;
     }
 
-    T _val1;
+private:
+    matcher_operand<T> _value;
 };
 
 template<class T>
 class AlmostEquals
 {
 public:
-    AlmostEquals(T v1, T precision)
-        : _val1(v1)
-        , precision(precision)
+    constexpr AlmostEquals(const T& value, const T& precision)
+        : _value(value)
+        , _precision(precision)
+    {
+    }
+
+    constexpr bool run(const T& value) const
+    {
+        return (_value > (value - _precision)) &&
+               (_value < (value + _precision));
+    }
+
+private:
+    matcher_operand<T> _value;
+    matcher_operand<T> _precision;
+};
+
+template<class T>
+class GreaterThan
+{
+public:
+    constexpr explicit GreaterThan(const T& bound)
+        : _bound(bound)
+    {
+    }
+
+    template<class U>
+    constexpr bool run(const U& value) const
+    {
+        return value > _bound;
+    }
+
+private:
+    matcher_operand<T> _bound;
+};
+
+template<class T>
+class LessThan
+{
+public:
+    constexpr explicit LessThan(const T& bound)
+        : _bound(bound)
+    {
+    }
+
+    template<class U>
+    constexpr bool run(const U& value) const
+    {
+        return value < _bound;
+    }
+
+private:
+    matcher_operand<T> _bound;
+};
+
+/*!
+ * @brief Matches the values between two bounds, both included
+ */
+template<class T>
+class InRange
+{
+public:
+    constexpr InRange(const T& low, const T& high)
+        : _low(low)
+        , _high(high)
+    {
+    }
+
+    template<class U>
+    constexpr bool run(const U& value) const
+    {
+        return !(value < _low) && !(_high < value);
+    }
+
+private:
+    matcher_operand<T> _low;
+    matcher_operand<T> _high;
+};
+
+/*!
+ * @brief Matches what every one of its matchers matches
+ *
+ * The matchers are stored in a tuple and the calls are folded, so the
+ * composition is resolved at compile time. Stops at the first mismatch.
+ */
+template<class... Matchers>
+class AllOf
+{
+public:
+    constexpr explicit AllOf(Matchers... matchers)
+        : _matchers(std::move(matchers)...)
+    {
+    }
+
+    template<class U>
+    constexpr bool run(const U& value) const
+    {
+        return std::apply([&](const auto&... matcher)
+                          { return (matcher.run(value) && ...); },
+                          _matchers);
+    }
+
+private:
+    std::tuple<Matchers...> _matchers;
+};
+
+/*!
+ * @brief Matches what at least one of its matchers matches. Stops at the
+ * first match
+ */
+template<class... Matchers>
+class AnyOf
+{
+public:
+    constexpr explicit AnyOf(Matchers... matchers)
+        : _matchers(std::move(matchers)...)
+    {
+    }
+
+    template<class U>
+    constexpr bool run(const U& value) const
+    {
+        return std::apply([&](const auto&... matcher)
+                          { return (matcher.run(value) || ...); },
+                          _matchers);
+    }
+
+private:
+    std::tuple<Matchers...> _matchers;
+};
+
+template<class Matcher>
+class Not
+{
+public:
+    constexpr explicit Not(Matcher matcher)
+        : _matcher(std::move(matcher))
     {
     }
 
-    bool run(T val2)
+    template<class U>
+    constexpr bool run(const U& value) const
     {
-        return (this->_val1 > (val2 - precision)) &&
-               (this->_val1 < (val2 + precision));
+        return !_matcher.run(value);
     }
 
-    T _val1;
-    T precision;
+private:
+    Matcher _matcher;
 };
 
 // These functions allows us to write equals(4) instead of Equals<int>(4)
 template<class T>
-unique_ptr<Equals<T>> equals(T val)
+constexpr Equals<T> equals(const T& value)
+{
+    return Equals<T>(value);
+}
+template<class T>
+constexpr NonEquals<T> non_equals(const T& value)
+{
+    return NonEquals<T>(value);
+}
+template<class T>
+constexpr AlmostEquals<T> almost_equals(const T& value, const T& precision)
+{
+    return AlmostEquals<T>(value, precision);
+}
+template<class T>
+constexpr GreaterThan<T> greater_than(const T& bound)
 {
-    return std::make_unique<Equals<T>>(val);
+    return GreaterThan<T>(bound);
 }
 template<class T>
-unique_ptr<NonEquals<T>> non_equals(T val)
+constexpr LessThan<T> less_than(const T& bound)
 {
-    return std::make_unique<NonEquals<T>>(val);
+    return LessThan<T>(bound);
 }
 template<class T>
-unique_ptr<AlmostEquals<T>> almost_equals(T val, T precision)
+constexpr InRange<T> in_range(const T& low, const T& high)
 {
-    return std::make_unique<AlmostEquals<T>>(val, precision);
+    return InRange<T>(low, high);
+}
+template<class... Matchers>
+constexpr AllOf<Matchers...> all_of(Matchers... matchers)
+{
+    return AllOf<Matchers...>(std::move(matchers)...);
+}
+template<class... Matchers>
+constexpr AnyOf<Matchers...> any_of(Matchers... matchers)
+{
+    return AnyOf<Matchers...>(std::move(matchers)...);
+}
+template<class Matcher>
+constexpr Not<Matcher> not_(Matcher matcher)
+{
+    return Not<Matcher>(std::move(matcher));
 }
 
 namespace detail
@@ -165,538 +383,5073 @@ enum class color
 
 // Variables
 
-inline map<string, map<string, std::function<void()>>> map_test_functions;
-inline map<string, vector<std::unique_ptr<Test>>>      fixtures_map;
-inline vector<Test*>                                   failed_fixtures;
-inline map<string, map<string, std::function<void()>>> failed_functions;
+struct async_body;
+
+/*!
+ * @brief A registered test
+ *
+ * Records only point to static data, so registering a test during the static
+ * initialization costs a few words in @ref registry and nothing else. Only
+ * one of the three ways to run the test is set.
+ */
+struct test_record
+{
+    std::string_view group;
+    std::string_view name;
 
-inline int error {0};
+    void (*function)();                         // TEST
+    std::unique_ptr<Test> (*make_fixture)();    // TEST_F
+    const std::function<void()>* callable;      // add_test
 
-inline color current_color {color::White};
+    std::string_view tags;    // Separated by spaces or commas
 
-const inline std::map<color, string> color_code    // can't constexpr sadly
-    {
-        {color::Black, "30m"},  {color::Red, "31m"},   {color::Green, "32m"},
-        {color::Yellow, "33m"}, {color::Blue, "34m"},  {color::Magenta, "35m"},
-        {color::Cyan, "36m"},   {color::White, "37m"},
-    };
+    std::chrono::milliseconds timeout {0};    // 0 uses the run's timeout
 
-// Some code are probably wrong here
-const inline std::map<color, int> win_color_code {
-    {color::Black, 1},   {color::Red, 4},   {color::Green, 2},
-    {color::Yellow, 14}, {color::Blue, 5},  {color::Magenta, 6},
-    {color::Cyan, 3},    {color::White, 8},
+    // TEST_ASYNC, whose function runs the coroutine on its own. Always there
+    // so the record looks the same whether coroutines are available or not
+    const async_body* async {nullptr};
 };
 
 /*!
- * @brief Just a shortcut so I don't have to write std::cout<< text << "\n" all
- * the time
+ * @brief Every registered test, in registration order until @ref run_all
+ * sorts it
  */
-inline void write_line(const string& str)
-{
-    std::cout << "\033[0;" << color_code.at(current_color) << str.c_str()
-              << "\033[0m" << std::endl;
-}
+inline vector<test_record> registry;
 
-inline void write(const string& str)
-{
-    std::cout << "\033[0;" << color_code.at(current_color) << str.c_str()
-              << "\033[0m" << std::flush;
-}
+// Storage for what add_test receives, since records only hold pointers.
+// Deques never move their elements around when growing
+inline std::deque<string>                dynamic_names;
+inline std::deque<std::function<void()>> dynamic_tests;
 
-inline void write(const string& str, color code_color)
+inline bool is_fixture(const test_record& record)
 {
-    current_color = code_color;
-    write(str);
+    return record.make_fixture != nullptr;
 }
 
 /*!
- * @brief  Write a line of text and changes the console color
- * @param line         Contains the text to be displayed
- * @param console_color   Contains a code corresponding to a color
+ * @brief Whether both records are listed under the same group header
+ *
+ * A fixture class and a group of TEST functions are still reported
+ * separately if they happen to share the same name
  */
-inline void write_line(const string& line, color console_color)
+inline bool same_group(const test_record& a, const test_record& b)
 {
-    current_color = console_color;
-    write_line(line);
+    return a.group == b.group && is_fixture(a) == is_fixture(b);
 }
 
-template<class T>
-void log_test_error(const T       val,
-                    const string& value_name,
-                    const string& expected,
-                    const char*   file,
-                    int           line)
+/*!
+ * @brief Sorts @p records the way tests are reported : fixtures first, then
+ * by group and by name
+ *
+ * A test registered again under the same name, from another file or through
+ * add_test, only keeps its first registration.
+ *
+ * @return The full names of the registrations that were dropped
+ */
+inline vector<string> sort_registry(vector<test_record>& records)
 {
-    write_line("\n        ! Error : ", color::Red);
-    write("            * file :     ", color::Cyan);
-    write_line(file, color::Yellow);
-    write("            * line :     ", color::Cyan);
-    write_line(std::to_string(line), color::Magenta);
-    write("            * Check if ", color::Cyan);
-    write("\"" + value_name + "\" ", color::Magenta);
-    write("== ");
-    write_line("\"" + expected + "\"");
-    write("                * Expected : ", color::Cyan);
-    write_line(expected, color::Magenta);
-    write("                * Value is : ", color::Cyan);
+    std::stable_sort(records.begin(), records.end(),
+                     [](const test_record& a, const test_record& b)
+                     {
+                         if(is_fixture(a) != is_fixture(b))
+                             return is_fixture(a);
+                         if(a.group != b.group)
+                             return a.group < b.group;
+                         return a.name < b.name;
+                     });
 
-    std::stringstream ss;
-    ss << val;
-    write_line(ss.str(), color::Magenta);
-    error += 1;
+    vector<string> duplicates;
+    size_t         kept {0};
+
+    for(size_t i = 0; i < records.size(); i++)
+    {
+        if(kept > 0 && same_group(records[kept - 1], records[i]) &&
+           records[kept - 1].name == records[i].name)
+        {
+            duplicates.push_back(string(records[i].group) + "." +
+                                 string(records[i].name));
+            continue;
+        }
+        records[kept++] = records[i];
+    }
+    records.resize(kept);
+    return duplicates;
 }
 
 /*!
- * @brief
+ * @brief Full names of the tests that failed, in the order they were reported
  */
-template<class T, class U>
-void assert_that_(T             val,
-                  U&&           checker,
-                  const string& value,
-                  const string& expected,
-                  const char*   file,
-                  int           line)
-{
-    if(checker->run(val) == false)
-        log_test_error(val, value, expected, file, line);
-}
+inline vector<string> failed_tests;
 
-template<class T>
-void check_equals_(T val1, T val2, const char* file, int line)
-{
-    if(val1 != val2)
-    {
-        write_line("        ! Error : ", color::Red);
-        write("            * file :     ", color::Cyan);
-        write_line(file, color::Yellow);
-        write("            * line :     ", color::Cyan);
-        write_line(std::to_string(line), color::Magenta);
-        write("            * Check equals \n", color::Cyan);
-        write("                * val1 : ", color::Cyan);
-        std::stringstream ss;
-        ss << val1;
-        write_line(ss.str(), color::Magenta);
-
-        write("                * val2  : ", color::Cyan);
-        std::stringstream ss2;
-        ss2 << val2;
-        write_line(ss2.str(), color::Magenta);
+/*!
+ * @brief Total of failed checks, updated once a test is done
+ *
+ * Checks failing on a thread that doesn't belong to any test land here too,
+ * from any thread.
+ */
+inline std::atomic<int> error {0};
 
-        error += 1;
-    }
-}
+/*!
+ * @brief Duration and outcome of the tests, read before the run and updated
+ * as tests are done. Empty when the run keeps no history
+ */
+inline std::optional<run_history> history;
 
-template<class T>
-void check_non_equals_(T val1, T val2, const char* file, int line)
-{
-    if(val1 == val2)
-    {
-        write_line("        ! Error : ", color::Red);
-        write("            * file :     ", color::Cyan);
-        write_line(file, color::Yellow);
-        write("            * line :     ", color::Cyan);
-        write_line(std::to_string(line), color::Magenta);
-        write("            * Check non equals \n", color::Cyan);
-        write("                * val1 : ", color::Cyan);
-        std::stringstream ss;
-        ss << val1;
-        write_line(ss.str(), color::Magenta);
-
-        write("                * val2  : ", color::Cyan);
-        std::stringstream ss2;
-        ss2 << val2;
-        write_line(ss2.str(), color::Magenta);
+/*!
+ * @brief Stops starting tests once one of them failed
+ */
+inline bool fail_fast {false};
 
-        error += 1;
-    }
-}
+/*!
+ * @brief Set once a test failed while @ref fail_fast is on. Tests that didn't
+ * start yet are skipped
+ */
+inline std::atomic<bool> stopping {false};
 
 /*!
- * @brief      Register a test function
- *  Called by the TEST macro.  The TEST macro declares a function
- *  that will be named from the combination of the @ref group_name and @ref
- *  function_name parameters.
- *  Then, it will create a unique variable whose only goal is to call
- *  the register_function with a pointer to the previously declared
- * function, along with the function name and the group (parameters of the
- * TEST macro) Finally, it will start the function definition.
- *  @param func             Pointer to the test function created by the TEST
- * macro
- *  @param group_name       First parameter of the TEST macro. Correspond to
- * the group in which the function belong
- *  @param function_name    Second parameter of the TEST macro. Correspond
- * to the function name.
+ * @brief Tests that never ran because of @ref fail_fast
  */
-inline int register_function(void (*func_ptr)(),
-                             const string& function,
-                             const string& group)
+inline size_t skipped_tests {0};
+
+/*!
+ * @brief Failures of a test reported in full, before the next ones are only
+ * counted. 0 reports every failure
+ */
+inline std::atomic<int> reported_failures {10};
+
+/*!
+ * @brief Cases every property runs
+ */
+inline size_t property_cases {100};
+
+/*!
+ * @brief Threads running the cases of a property. 0 uses one per hardware
+ * thread
+ */
+inline unsigned property_jobs {0};
+
+/*!
+ * @brief Seed the cases of every property derive from. 0 picks a random one
+ * the first time a property runs
+ */
+inline std::uint64_t property_seed {0};
+
+/*!
+ * @brief Failures of a test that weren't reported, counted by call site
+ *
+ * Only touched once a test failed more than @ref reported_failures times, so
+ * the lock is never taken by a passing check.
+ */
+class silenced_failures
 {
-    map_test_functions[group][function] = func_ptr;
-    return 0;    // We only return a value because of the affectation trick in
-                 // the macro
-}
+public:
+    using site = std::pair<std::string_view, int>;    // File and line
+
+    void add(std::string_view file, int line)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _sites[site(file, line)]++;
+    }
+
+    /*!
+     * @brief Every call site with how many of its failures were silenced,
+     * sorted by file and line
+     */
+    vector<std::pair<site, long long>> take()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        vector<std::pair<site, long long>> result(_sites.begin(), _sites.end());
+        _sites.clear();
+        return result;
+    }
+
+private:
+    std::mutex                _mutex;
+    std::map<site, long long> _sites;
+};
 
 /*!
- *   @brief Register a fixture object
+ * @brief Reports of the checks that failed on the threads a test started
+ *
+ * Threads only push, with a compare and swap, and the runner takes the whole
+ * list once the test body is done, so reporting never waits on a lock.
  */
-template<class T>
-inline int register_fixture(const string& class_name, const string& test_name)
+class failure_records
 {
-    try
+public:
+    failure_records() = default;
+
+    failure_records(const failure_records&)            = delete;
+    failure_records& operator=(const failure_records&) = delete;
+
+    ~failure_records() { take(); }
+
+    void push(string text)
+    {
+        auto* record = new node {std::move(text), nullptr};
+        record->next = _head.load(std::memory_order_relaxed);
+
+        while(!_head.compare_exchange_weak(record->next, record,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed))
+        {
+        }
+    }
+
+    /*!
+     * @brief Empties the list, and returns the records in the order they
+     * were pushed
+     */
+    vector<string> take()
+    {
+        auto* head = _head.exchange(nullptr, std::memory_order_acquire);
+
+        vector<string> result;
+        while(head != nullptr)
+        {
+            result.push_back(std::move(head->text));
+            delete std::exchange(head, head->next);
+        }
+        std::reverse(result.begin(), result.end());
+        return result;
+    }
+
+private:
+    struct node
+    {
+        string text;
+        node*  next;
+    };
+
+    std::atomic<node*> _head {nullptr};
+};
+
+/*!
+ * @brief Failure state of a single test
+ *
+ * Every test runs with its own context, so tests running on different workers
+ * never share anything while they run. The runner adds the context's errors
+ * to @ref error once the test is done.
+ *
+ * Only the thread running the test touches @ref errors. Threads started by
+ * the test count their failures in @ref thread_errors, and keep their
+ * reports in @ref thread_failures.
+ */
+struct test_context
+{
+    int              errors {0};
+    allocation_scope allocations;    // Started when the test body starts
+
+    std::atomic<int> thread_errors {0};
+    failure_records  thread_failures;
+
+    std::atomic<int>  reported {0};    // Failures that went through the check
+    silenced_failures silenced;
+};
+
+/*!
+ * @brief Context of the test running on the current thread, if any
+ */
+inline thread_local test_context* current_context {nullptr};
+
+/*!
+ * @brief Context of the test that started the current thread, if the thread
+ * was attached to it
+ */
+inline thread_local test_context* attached_context {nullptr};
+
+/*!
+ * @brief Context of the only test running in the process, if tests run one
+ * at a time
+ *
+ * Threads that weren't attached to a test still count their failures for
+ * it, since it's the only one that could have started them.
+ */
+inline std::atomic<test_context*> lone_context {nullptr};
+
+/*!
+ * @brief Context receiving the failures of a thread that doesn't run a test
+ * itself
+ */
+inline test_context* shared_context()
+{
+    if(attached_context != nullptr)
+        return attached_context;
+    return lone_context.load(std::memory_order_acquire);
+}
+
+/*!
+ * @brief Called by every check that fails
+ *
+ * Safe from any thread. The failure counts for the test running on the
+ * calling thread, or else the test the thread was started from.
+ */
+inline void notify_error()
+{
+    if(current_context != nullptr)
+        current_context->errors += 1;
+    else if(auto* context = shared_context())
+        context->thread_errors.fetch_add(1, std::memory_order_relaxed);
+    else
+        error.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline thread_local color current_color {color::White};
+
+inline std::unique_ptr<output_sink> current_sink;
+
+/*!
+ * @brief Sink receiving the output, a synchronous one if none was set
+ */
+inline output_sink& sink()
+{
+    if(current_sink == nullptr)
+        current_sink = std::make_unique<stream_sink>();
+    return *current_sink;
+}
+
+/*!
+ * @brief Buffer the current thread writes into, if any
+ *
+ * The runner points it to the buffer of the test being run, and hands the
+ * buffer to the sink once the test is done. When null, every write goes to
+ * the sink on its own.
+ */
+inline thread_local string* output_buffer {nullptr};
+
+/*!
+ * @brief Redirects the output of the current thread to @p buffer for as long
+ * as the object lives
+ */
+class capture_output
+{
+public:
+    explicit capture_output(string& buffer)
+        : _previous(std::exchange(output_buffer, &buffer))
+    {
+    }
+
+    capture_output(const capture_output&)            = delete;
+    capture_output& operator=(const capture_output&) = delete;
+
+    ~capture_output() { output_buffer = _previous; }
+
+private:
+    string* _previous;
+};
+
+/*!
+ * @brief Appends @p text to the current buffer, or writes it to the sink
+ */
+inline void write_raw(string text)
+{
+    if(output_buffer != nullptr)
+        *output_buffer += text;
+    else
+        sink().write(std::move(text));
+}
+
+const inline std::map<color, string> color_code    // can't constexpr sadly
+    {
+        {color::Black, "30m"},  {color::Red, "31m"},   {color::Green, "32m"},
+        {color::Yellow, "33m"}, {color::Blue, "34m"},  {color::Magenta, "35m"},
+        {color::Cyan, "36m"},   {color::White, "37m"},
+    };
+
+// Some code are probably wrong here
+const inline std::map<color, int> win_color_code {
+    {color::Black, 1},   {color::Red, 4},   {color::Green, 2},
+    {color::Yellow, 14}, {color::Blue, 5},  {color::Magenta, 6},
+    {color::Cyan, 3},    {color::White, 8},
+};
+
+/*!
+ * @brief Writes @p str with the current color, without going through a
+ * temporary when there's a buffer to append to
+ */
+inline void write_colored(const string& str, bool new_line)
+{
+    string  text;
+    string& target = output_buffer != nullptr ? *output_buffer : text;
+
+    target += "\033[0;";
+    target += color_code.at(current_color);
+    target += str;
+    target += "\033[0m";
+
+    if(new_line)
+        target += '\n';
+
+    if(output_buffer == nullptr)
+        sink().write(std::move(text));
+}
+
+/*!
+ * @brief Just a shortcut so I don't have to write std::cout<< text << "\n" all
+ * the time
+ */
+inline void write_line(const string& str)
+{
+    write_colored(str, true);
+}
+
+inline void write(const string& str)
+{
+    write_colored(str, false);
+}
+
+inline void write(const string& str, color code_color)
+{
+    current_color = code_color;
+    write(str);
+}
+
+/*!
+ * @brief  Write a line of text and changes the console color
+ * @param line         Contains the text to be displayed
+ * @param console_color   Contains a code corresponding to a color
+ */
+inline void write_line(const string& line, color console_color)
+{
+    current_color = console_color;
+    write_line(line);
+}
+
+/*!
+ * @brief Hands over the report of a failed check in one block, and counts
+ * the failure
+ *
+ * The thread running the test writes it like any other output. Other threads
+ * keep it with the failures of their test, which are written once its body
+ * is done, so reports of different threads never interleave.
+ */
+inline void publish_failure(string text)
+{
+    if(current_context == nullptr)
+        if(auto* context = shared_context())
+        {
+            context->thread_failures.push(std::move(text));
+            context->thread_errors.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+    write_raw(std::move(text));
+    notify_error();
+}
+
+/*!
+ * @brief Gathers what is written about a failed check for as long as the
+ * object lives, then publishes it with @ref publish_failure
+ */
+class failure_report
+{
+public:
+    failure_report() { _capture.emplace(_text); }
+
+    failure_report(const failure_report&)            = delete;
+    failure_report& operator=(const failure_report&) = delete;
+
+    ~failure_report()
+    {
+        _capture.reset();
+        publish_failure(std::move(_text));
+    }
+
+private:
+    string                        _text;
+    std::optional<capture_output> _capture;
+};
+
+/*!
+ * @brief Counts a failure without reporting it, if its test already failed
+ * @ref reported_failures times
+ *
+ * A check failing inside a long loop then costs a count instead of a whole
+ * report. The silenced failures are summed up once the test is done.
+ *
+ * @return True if the failure was counted, and mustn't be reported
+ */
+inline bool silence_failure(const char* file, int line)
+{
+    auto* context =
+        current_context != nullptr ? current_context : shared_context();
+    const int budget = reported_failures.load(std::memory_order_relaxed);
+
+    if(context == nullptr || budget == 0 ||
+       context->reported.fetch_add(1, std::memory_order_relaxed) < budget)
+        return false;
+
+    context->silenced.add(file, line);
+    notify_error();
+    return true;
+}
+
+/*!
+ * @brief Writes how many failures of every call site weren't reported
+ */
+inline void log_silenced_failures(test_context& context)
+{
+    const auto sites = context.silenced.take();
+    if(sites.empty())
+        return;
+
+    long long total {0};
+    for(const auto& site : sites)
+        total += site.second;
+
+    write_line("\n        ! " + std::to_string(total) +
+                   " more failures were only counted :",
+               color::Red);
+
+    for(const auto& [site, count] : sites)
+        write_line("            * " + string(site.first) + ":" +
+                       std::to_string(site.second) + " : " +
+                       std::to_string(count),
+                   color::Cyan);
+}
+
+template<class T>
+void log_test_error(const T&    val,
+                    const char* value_name,
+                    const char* expected,
+                    const char* file,
+                    int         line)
+{
+    if(silence_failure(file, line))
+        return;
+
+    failure_report report;
+
+    write_line("\n        ! Error : ", color::Red);
+    write("            * file :     ", color::Cyan);
+    write_line(file, color::Yellow);
+    write("            * line :     ", color::Cyan);
+    write_line(std::to_string(line), color::Magenta);
+    write("            * Check if ", color::Cyan);
+    write("\"" + string(value_name) + "\" ", color::Magenta);
+    write("== ");
+    write_line("\"" + string(expected) + "\"");
+    write("                * Expected : ", color::Cyan);
+    write_line(expected, color::Magenta);
+    write("                * Value is : ", color::Cyan);
+
+    std::stringstream ss;
+    ss << val;
+    write_line(ss.str(), color::Magenta);
+}
+
+template<class T, class = void>
+struct is_pointer_like : std::false_type
+{
+};
+
+template<class T>
+struct is_pointer_like<
+    T,
+    std::void_t<decltype(std::declval<const T&>().operator->())>>
+    : std::true_type
+{
+};
+
+/*!
+ * @brief Runs @p checker on @p value, whether it's a matcher or points to one
+ *
+ * Matchers used to be handed out by std::unique_ptr, which user defined
+ * matchers may still do.
+ */
+template<class T, class U>
+constexpr bool run_matcher(const U& checker, const T& value)
+{
+    if constexpr(std::is_class_v<U> && !is_pointer_like<U>::value)
+        return checker.run(value);
+    else
+        return checker->run(value);
+}
+
+/*!
+ * @brief Checks @p val against @p checker
+ *
+ * Nothing is copied nor allocated unless the check fails: the value and the
+ * matcher are taken by reference, and the expressions stay string literals
+ * until they're logged.
+ */
+template<class T, class U>
+void assert_that_(const T&    val,
+                  const U&    checker,
+                  const char* value,
+                  const char* expected,
+                  const char* file,
+                  int         line)
+{
+    if(!run_matcher(checker, val))
+        log_test_error(val, value, expected, file, line);
+}
+
+/*!
+ * @brief Reports a check_equals or check_non_equals that failed, with the
+ * values already written
+ *
+ * @param check "equals" or "non equals"
+ */
+inline void log_comparison_error(const char*   check,
+                                 const string& val1,
+                                 const string& val2,
+                                 const char*   file,
+                                 int           line)
+{
+    failure_report report;
+
+    write_line("        ! Error : ", color::Red);
+    write("            * file :     ", color::Cyan);
+    write_line(file, color::Yellow);
+    write("            * line :     ", color::Cyan);
+    write_line(std::to_string(line), color::Magenta);
+    write("            * Check " + string(check) + " \n", color::Cyan);
+    write("                * val1 : ", color::Cyan);
+    write_line(val1, color::Magenta);
+    write("                * val2  : ", color::Cyan);
+    write_line(val2, color::Magenta);
+}
+
+template<class T>
+string format_value(const T& value)
+{
+    std::stringstream ss;
+    ss << value;
+    return ss.str();
+}
+
+template<class T>
+void check_equals_(const T& val1, const T& val2, const char* file, int line)
+{
+    if(val1 != val2 && !silence_failure(file, line))
+        log_comparison_error("equals", format_value(val1), format_value(val2),
+                             file, line);
+}
+
+template<class T>
+void check_non_equals_(const T&    val1,
+                       const T&    val2,
+                       const char* file,
+                       int         line)
+{
+    if(val1 == val2 && !silence_failure(file, line))
+        log_comparison_error("non equals", format_value(val1),
+                             format_value(val2), file, line);
+}
+
+inline string describe_match(const exact_match&)
+{
+    return "equals";
+}
+
+inline string describe_match(const near_match& match)
+{
+    std::ostringstream stream;
+    stream << "near, absolute tolerance " << match.absolute
+           << ", relative tolerance " << match.relative;
+    return stream.str();
+}
+
+inline string describe_match(const ulp_match& match)
+{
+    return "within " + std::to_string(match.max_ulps) + " ulps";
+}
+
+/*!
+ * @brief Writes @p value with every digit needed to tell it apart from its
+ * neighbours
+ */
+template<class T>
+string format_element(const T& value)
+{
+    std::ostringstream stream;
+    if constexpr(std::is_floating_point_v<T>)
+        stream << std::setprecision(std::numeric_limits<T>::max_digits10);
+    stream << value;
+    return stream.str();
+}
+
+/*!
+ * @brief Compares two contiguous ranges element by element with @p match
+ *
+ * The comparison goes through vectorized kernels when there's one for the
+ * element type. A failure is reported once for the whole range, with the
+ * number of mismatches and the first elements that differ.
+ */
+template<class Actual, class Expected, class Match>
+void check_range_(const Actual&   actual,
+                  const Expected& expected,
+                  const Match&    match,
+                  const char*     actual_name,
+                  const char*     expected_name,
+                  const char*     file,
+                  int             line)
+{
+    using element = std::remove_cv_t<
+        std::remove_reference_t<decltype(*std::data(actual))>>;
+    using expected_element = std::remove_cv_t<
+        std::remove_reference_t<decltype(*std::data(expected))>>;
+    static_assert(std::is_same_v<element, expected_element>,
+                  "Both ranges must hold the same type");
+
+    const auto size = static_cast<size_t>(std::size(actual));
+    const bool same_size =
+        size == static_cast<size_t>(std::size(expected));
+
+    range_mismatches mismatches;
+    if(same_size)
+    {
+        mismatches = compare_ranges(match, std::data(actual),
+                                    std::data(expected), size);
+        if(mismatches.count == 0)
+            return;
+    }
+
+    if(silence_failure(file, line))
+        return;
+
+    failure_report report;
+
+    write_line("\n        ! Error : ", color::Red);
+    write("            * file :     ", color::Cyan);
+    write_line(file, color::Yellow);
+    write("            * line :     ", color::Cyan);
+    write_line(std::to_string(line), color::Magenta);
+    write("            * Check range ", color::Cyan);
+    write("\"" + string(actual_name) + "\" ", color::Magenta);
+    write(describe_match(match) + " ", color::Cyan);
+    write_line("\"" + string(expected_name) + "\"", color::Magenta);
+
+    if(!same_size)
+    {
+        write("                * Sizes : ", color::Cyan);
+        write_line(std::to_string(size) + " and " +
+                       std::to_string(std::size(expected)),
+                   color::Magenta);
+        return;
+    }
+
+    write("                * Mismatches : ", color::Cyan);
+    write_line(std::to_string(mismatches.count) + " out of " +
+                   std::to_string(size),
+               color::Magenta);
+
+    for(size_t i = 0; i < mismatches.kept_count(); i++)
+    {
+        const auto index = mismatches.indices[i];
+        write("                * [" + std::to_string(index) + "] : ",
+              color::Cyan);
+        write_line(format_element(std::data(actual)[index]) + " instead of " +
+                       format_element(std::data(expected)[index]),
+                   color::Magenta);
+    }
+
+    if(mismatches.count > mismatches.kept_count())
+        write_line("                * And " +
+                       std::to_string(mismatches.count -
+                                      mismatches.kept_count()) +
+                       " more",
+                   color::Cyan);
+}
+
+/*!
+ * @brief Checks that the running test body didn't allocate more than
+ * @p maximum times so far
+ *
+ * Fails when allocations aren't tracked, since the budget couldn't be checked
+ */
+inline void check_max_allocations_(size_t maximum, const char* file, int line)
+{
+    if(current_context == nullptr)
+        return;
+
+    const auto allocations = current_context->allocations.stats().allocations;
+
+    if(allocation_tracking && allocations <= maximum)
+        return;
+
+    if(silence_failure(file, line))
+        return;
+
+    failure_report report;
+
+    write_line("\n        ! Error : ", color::Red);
+    write("            * file :     ", color::Cyan);
+    write_line(file, color::Yellow);
+    write("            * line :     ", color::Cyan);
+    write_line(std::to_string(line), color::Magenta);
+
+    if(!allocation_tracking)
+    {
+        write_line("            * Allocations aren't tracked, define "
+                   "CORGI_TEST_TRACK_ALLOCATIONS in one file",
+                   color::Cyan);
+    }
+    else
+    {
+        write("            * Check max allocations \n", color::Cyan);
+        write("                * Maximum : ", color::Cyan);
+        write_line(std::to_string(maximum), color::Magenta);
+        write("                * Made    : ", color::Cyan);
+        write_line(std::to_string(allocations), color::Magenta);
+    }
+}
+
+/*!
+ * @brief      Register a test function
+ *  Called by the TEST macro.  The TEST macro declares a function
+ *  that will be named from the combination of the @ref group_name and @ref
+ *  function_name parameters.
+ *  Then, it will create a unique variable whose only goal is to call
+ *  the register_function with a pointer to the previously declared
+ * function, along with the function name and the group (parameters of the
+ * TEST macro) Finally, it will start the function definition.
+ *  @param func             Pointer to the test function created by the TEST
+ * macro
+ *  @param group_name       First parameter of the TEST macro. Correspond to
+ * the group in which the function belong
+ *  @param function_name    Second parameter of the TEST macro. Correspond
+ * to the function name.
+ */
+inline int register_function(void (*func_ptr)(),
+                             std::string_view          function,
+                             std::string_view          group,
+                             std::string_view          tags    = {},
+                             std::chrono::milliseconds timeout = {})
+{
+    registry.push_back(
+        {group, function, func_ptr, nullptr, nullptr, tags, timeout, nullptr});
+    return 0;    // We only return a value because of the affectation trick in
+                 // the macro
+}
+
+/*!
+ * @brief Registers a TEST_ASYNC : @p func_ptr runs @p body alone, while the
+ * serial runner starts @p body along the other coroutine tests
+ */
+inline int register_async(void (*func_ptr)(),
+                          const async_body&         body,
+                          std::string_view          function,
+                          std::string_view          group,
+                          std::string_view          tags    = {},
+                          std::chrono::milliseconds timeout = {})
+{
+    registry.push_back(
+        {group, function, func_ptr, nullptr, nullptr, tags, timeout, &body});
+    return 0;
+}
+
+template<class T>
+std::unique_ptr<Test> make_fixture()
+{
+    return std::make_unique<T>();
+}
+
+template<class T, class = void>
+struct has_timeout : std::false_type
+{
+};
+
+template<class T>
+struct has_timeout<T, std::void_t<decltype(T::timeout)>> : std::true_type
+{
+};
+
+/*!
+ *   @brief Register a fixture
+ *
+ *   Only a pointer to a function able to build the fixture is kept. The
+ *   fixture itself is built when its test runs, so a fixture that throws
+ *   from its constructor fails its test instead of the static initialization.
+ *
+ *   A fixture class with a static timeout member, a std::chrono duration,
+ *   gives that timeout to all of its tests.
+ */
+template<class T>
+inline int register_fixture(std::string_view class_name,
+                            std::string_view test_name,
+                            std::string_view tags = {})
+{
+    std::chrono::milliseconds timeout {0};
+    if constexpr(has_timeout<T>::value)
+        timeout =
+            std::chrono::duration_cast<std::chrono::milliseconds>(T::timeout);
+
+    registry.push_back({class_name, test_name, nullptr, &make_fixture<T>,
+                        nullptr, tags, timeout, nullptr});
+    return 0;    // We only return a value because of the affectation trick
+                 // in the macro
+}
+
+/*!
+ * @brief  Logs every failed function inside the console as a summary report
+ */
+inline void log_failed_functions()
+{
+    for(const auto& test_name : failed_tests)
+        write_line("      * " + test_name + " failed", color::Red);
+}
+
+/*!
+ * @brief  Logs that we successfully pass every test
+ */
+inline void log_success()
+{
+    write_line("    * Every test passed", color::Green);
+}
+
+/*!
+ * @brief  Logs that at least 1 test failed
+ */
+inline void log_failure()
+{
+    write_line("    Error : Some test failed to pass", color::Red);
+    write_line("    Logging the Functions that failed", color::Cyan);
+    log_failed_functions();
+
+    if(skipped_tests > 0)
+        write_line("    " + std::to_string(skipped_tests) +
+                       " tests were skipped after the first failure",
+                   color::Yellow);
+}
+
+/*!
+ *   @brief  Write an header in the console
+ *   @detail Just write something in that way inside the console
+ *   +---------+
+ *   |   Text  |
+ *   +---------+
+ */
+inline void write_title(const string& text)
+{
+    const int max_column = 78;
+
+    write("+", color::Green);
+    write(string(max_column - 2, '-'));
+    write("+\n");
+
+    write_line("|    " + text +
+               string(max_column - 1 - (5 + text.size()), ' ') + "|");
+
+    write("+");
+    write(string(max_column - 2, '-'));
+    write("+\n");
+}
+
+/*!
+ *   @brief  Logs that we're running tests that belongs to the @ref group_name
+ * group
+ *   @param  group_name  Name of the tested group
+ *   @param  group_size  How many test are inside the group
+ */
+inline void log_start_group(const string& group_name, size_t group_size)
+{
+    write_title("Running " + std::to_string(group_size) + " tests grouped in " +
+                group_name);
+}
+
+/*!
+ * @brief Log that we're starting a test
+ * @param test_name    Name of the test we're running
+ * @param group_name   Name of the group the test belongs to
+ * @param count        Counter used to know on which test from group we're (like
+ * the first one, the second one ? etc
+ */
+inline void log_start_test(const string& test_name,
+                           const string& group_name,
+                           size_t        group_size,
+                           size_t        count)
+{
+    write("  * Running ", color::Cyan);
+    write(group_name + "." + test_name, color::Yellow);
+    write(" (" + std::to_string(count) + "/" + std::to_string(group_size) +
+              ")\n",
+          color::Cyan);
+}
+
+/*!
+ * @brief  Log that a test was successful
+ *
+ * The allocations made by the test are only shown when they were tracked
+ */
+inline void log_test_success(long long              time,
+                             const allocation_stats& allocations)
+{
+    string line = "       Passed in " +
+                  std::to_string(static_cast<double>(time) / 1000.0) + " ms";
+
+    if(allocation_tracking)
+        line += ", " + std::to_string(allocations.allocations) +
+                " allocations (" + std::to_string(allocations.bytes) +
+                " bytes, peak " + std::to_string(allocations.peak_bytes) +
+                " bytes)";
+
+    write_line(line, color::Green);
+}
+}    // namespace detail
+
+/*!
+ * @brief Identifies a running test, so threads it starts can report to it
+ */
+struct test_handle
+{
+    detail::test_context* context {nullptr};
+};
+
+/*!
+ * @brief Test running on the current thread, or the test the thread was
+ * attached to
+ */
+inline test_handle current_test()
+{
+    if(detail::current_context != nullptr)
+        return {detail::current_context};
+    return {detail::attached_context};
+}
+
+/*!
+ * @brief Attaches the current thread to @p test for as long as the object
+ * lives
+ *
+ * Checks failing on the thread then count as failures of @p test, even when
+ * several tests run at the same time. The thread must be done before the
+ * test's body returns.
+ */
+class thread_scope
+{
+public:
+    explicit thread_scope(test_handle test)
+        : _previous(std::exchange(detail::attached_context, test.context))
+    {
+    }
+
+    thread_scope(const thread_scope&)            = delete;
+    thread_scope& operator=(const thread_scope&) = delete;
+
+    ~thread_scope() { detail::attached_context = _previous; }
+
+private:
+    detail::test_context* _previous;
+};
+
+/*!
+ * @brief Starts a thread running @p function, attached to the current test
+ */
+template<class Function>
+std::thread spawn(Function&& function)
+{
+    return std::thread(
+        [test = current_test(),
+         function = std::forward<Function>(function)]() mutable
+        {
+            thread_scope scope(test);
+            function();
+        });
+}
+
+// register the time it takes for a function to run
+template<class Function>
+inline auto function_time(Function&& fun) -> long long
+{
+    const auto start = std::chrono::steady_clock::now();
+    fun();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+        .count();
+}
+
+namespace detail
+{
+/*!
+ * @brief Calls @p function @p iterations times, and returns how long it took
+ * in nanoseconds
+ *
+ * The clock is only read twice per batch, and the callable isn't type erased,
+ * so it can be inlined inside the loop. A call costing a few nanoseconds is
+ * then measured instead of the harness around it.
+ */
+template<class Function>
+inline double time_batch(Function& function, size_t iterations)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; i++)
+        function();
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+/*!
+ * @brief Times batches of calls to a function whose type was erased
+ *
+ * The erasure costs one indirect call per batch, not per call.
+ */
+using batch_function = std::function<double(size_t)>;
+
+template<class Function>
+batch_function make_batch_function(Function function)
+{
+    return [function = std::move(function)](size_t iterations) mutable
+    { return time_batch(function, iterations); };
+}
+}    // namespace detail
+
+/*!
+ * @brief How benchmarks measure the functions they run
+ */
+struct benchmark_settings
+{
+    /*!
+     * @brief Time spent running a function before measuring it, so caches,
+     * branch predictors and CPU frequency have settled
+     */
+    std::chrono::nanoseconds warmup_time {std::chrono::milliseconds(50)};
+
+    /*!
+     * @brief How long a sample should last
+     *
+     * A sample runs the function as many times as needed to last about that
+     * long, so the clock resolution and the cost of reading it don't matter
+     * anymore
+     */
+    std::chrono::nanoseconds sample_time {std::chrono::milliseconds(5)};
+
+    /*!
+     * @brief Counts cycles, instructions, cache and branch misses around
+     * every sample, when the system allows it. Linux only
+     */
+    bool hardware_counters {false};
+};
+
+/*!
+ * @brief Options used by @ref run_all
+ */
+struct options
+{
+    /*!
+     * @brief How many tests can run at the same time
+     *
+     * 1 runs every test on the calling thread, 0 uses one worker per hardware
+     * thread
+     */
+    unsigned jobs {1};
+
+    /*!
+     * @brief Runs every test inside its own child process
+     *
+     * The children are forked from the test executable once it is fully
+     * initialized, and at most @ref jobs of them run at the same time. A test
+     * that crashes only fails itself instead of ending the whole run.
+     * Only available on platforms that have fork, tests run in process
+     * everywhere else.
+     */
+    bool isolate {false};
+
+    /*!
+     * @brief Writes the output as it comes, on the thread running the test
+     *
+     * By default, the output of a test is buffered and handed in one block to
+     * a background thread that writes it. The synchronous output is slower,
+     * but what a test printed is already written if the process dies.
+     */
+    bool sync_output {false};
+
+    /*!
+     * @brief Only runs the tests whose full name, "group.name", matches one of
+     * these patterns. '*' matches any sequence and '?' any character
+     */
+    vector<string> filters;
+
+    /*!
+     * @brief Skips the tests whose full name matches one of these patterns
+     */
+    vector<string> excludes;
+
+    /*!
+     * @brief Only runs the tests that have at least one of these tags
+     */
+    vector<string> tags;
+
+    /*!
+     * @brief Lists the selected tests as JSON instead of running them
+     */
+    bool list {false};
+
+    /*!
+     * @brief Longest a test can run, for the tests without their own
+     * timeout. 0 for no limit
+     *
+     * A test running in process that times out aborts the whole run, after
+     * saying which test hung. An isolated test is killed instead, fails, and
+     * the run goes on.
+     */
+    std::chrono::milliseconds timeout {0};
+
+    /*!
+     * @brief File keeping the duration and outcome of every test between
+     * runs. Left empty to keep nothing
+     *
+     * Once a history exists, parallel and isolated runs start the longest
+     * tests first, which shortens the tail of the run. Tests are still
+     * reported in the same order.
+     */
+    string history;
+
+    /*!
+     * @brief Runs the tests that failed last time before the others.
+     * Needs a @ref history
+     */
+    bool failed_first {false};
+
+    /*!
+     * @brief Stops starting tests once one of them failed
+     *
+     * Tests already running when it happens still finish and are reported.
+     */
+    bool fail_fast {false};
+
+    /*!
+     * @brief Failures of a test reported in full. The next ones are only
+     * counted by file and line, and summed up at the end of the test. 0
+     * reports every failure
+     */
+    int reported_failures {10};
+
+    /*!
+     * @brief Cases every PROPERTY runs, and how many threads run them. 0
+     * jobs uses one thread per hardware thread
+     */
+    size_t   property_cases {100};
+    unsigned property_jobs {0};
+
+    /*!
+     * @brief Seed the property cases derive from. 0 picks a random one, shown
+     * when a property fails
+     */
+    unsigned seed {0};
+
+    /*!
+     * @brief Only runs one of @ref shard_count parts of the selected tests,
+     * to split a suite over several machines
+     *
+     * Without a @ref history, tests are split by a hash of their name.
+     * With one, they're split so every shard takes about as long. Every
+     * machine must then read the same history to agree on the shards.
+     */
+    unsigned shard_index {0};
+    unsigned shard_count {1};
+
+    /*!
+     * @brief Files receiving a JSON lines and a JUnit XML report, as the run
+     * goes. Left empty for no report
+     */
+    string json_report;
+    string junit_report;
+
+    /*!
+     * @brief Baseline file the benchmarks are compared to. A candidate whose
+     * median got slower than @ref regression_tolerance allows fails the run
+     */
+    string compare_baseline;
+
+    /*!
+     * @brief File where the benchmark results are saved as the new baseline
+     */
+    string save_baseline;
+
+    /*!
+     * @brief Slowdown allowed against the baseline, 0.1 for 10%, for the
+     * benchmarks that don't have their own tolerance
+     */
+    double regression_tolerance {0.1};
+
+    benchmark_settings benchmark;
+};
+
+struct benchmark;
+struct benchmark_result;
+struct range_benchmark;
+struct range_benchmark_result;
+struct threaded_benchmark;
+struct threaded_benchmark_result;
+
+/*!
+ * @brief What a reporter is told about a test once it is done
+ */
+struct test_report
+{
+    std::string_view group;
+    std::string_view name;
+    size_t           index {0};    // Position inside the group, starting at 1
+    size_t           group_size {0};
+    int              errors {0};
+    long long        time {0};    // In microseconds
+    allocation_stats allocations;
+    bool             skipped {false};    // Never ran because of fail fast
+};
+
+/*!
+ * @brief Receives the results of a run while it happens
+ *
+ * Every event is sent from the thread that called @ref run_all, in the order
+ * the tests are reported in the log, no matter how they ran. A reporter is
+ * expected to write each event as it comes instead of keeping it, so its
+ * memory doesn't grow with the size of the suite.
+ */
+class reporter
+{
+public:
+    virtual ~reporter() = default;
+
+    virtual void run_started(size_t /*test_count*/) {}
+    virtual void test_finished(const test_report& /*report*/) {}
+    virtual void benchmark_finished(const benchmark& /*benchmark*/,
+                                    const benchmark_result& /*result*/)
+    {
+    }
+    virtual void
+    range_benchmark_finished(const range_benchmark& /*benchmark*/,
+                             const range_benchmark_result& /*result*/)
+    {
+    }
+    virtual void
+    threaded_benchmark_finished(const threaded_benchmark& /*benchmark*/,
+                                const threaded_benchmark_result& /*result*/)
+    {
+    }
+    virtual void run_finished(int /*errors*/) {}
+};
+
+namespace detail
+{
+/*!
+ * @brief Reporters of the current run, see @ref add_reporter
+ */
+inline vector<unique_ptr<reporter>> reporters;
+
+/*!
+ * @brief A test selected to run
+ */
+struct test_case
+{
+    test_record record {};
+    size_t      group_size {0};
+    size_t      index {0};    // Position inside the group, starting at 1
+};
+
+/*!
+ * @brief What a test did while it ran
+ */
+struct test_result
+{
+    int              errors {0};
+    long long        time {0};
+    allocation_stats allocations;    // Made by the test body
+    string           output;         // Only filled when the output was captured
+};
+
+/*!
+ * @brief Sets the position of every test inside its group
+ *
+ * Tests of the same group must be next to each other
+ */
+inline void number_groups(vector<test_case>& tests)
+{
+    for(size_t begin = 0; begin < tests.size();)
+    {
+        size_t end = begin + 1;
+
+        while(end < tests.size() &&
+              same_group(tests[end].record, tests[begin].record))
+            end++;
+
+        for(size_t i = begin; i < end; i++)
+        {
+            tests[i].group_size = end - begin;
+            tests[i].index      = i - begin + 1;
+        }
+        begin = end;
+    }
+}
+
+/*!
+ * @brief Calls @p callback with every tag inside @p tags
+ */
+template<class Callback>
+void for_each_tag(std::string_view tags, Callback&& callback)
+{
+    size_t begin {0};
+
+    while(begin < tags.size())
+    {
+        auto end = tags.find_first_of(" ,", begin);
+        if(end == std::string_view::npos)
+            end = tags.size();
+
+        if(end > begin)
+            callback(tags.substr(begin, end - begin));
+        begin = end + 1;
+    }
+}
+
+/*!
+ * @brief Checks if "group.name" matches @p pattern without building the
+ * string. '*' matches any sequence of characters and '?' any character
+ */
+inline bool matches(std::string_view pattern, const test_record& record)
+{
+    const size_t size = record.group.size() + 1 + record.name.size();
+
+    auto at = [&](size_t i) -> char
+    {
+        if(i < record.group.size())
+            return record.group[i];
+        if(i == record.group.size())
+            return '.';
+        return record.name[i - record.group.size() - 1];
+    };
+
+    size_t p {0};
+    size_t t {0};
+    size_t star {std::string_view::npos};
+    size_t star_t {0};
+
+    while(t < size)
+    {
+        if(p < pattern.size() && (pattern[p] == '?' || pattern[p] == at(t)))
+        {
+            p++;
+            t++;
+        }
+        else if(p < pattern.size() && pattern[p] == '*')
+        {
+            star   = p++;
+            star_t = t;
+        }
+        else if(star != std::string_view::npos)
+        {
+            p = star + 1;
+            t = ++star_t;
+        }
+        else
+            return false;
+    }
+
+    while(p < pattern.size() && pattern[p] == '*')
+        p++;
+    return p == pattern.size();
+}
+
+/*!
+ * @brief Looks up tests by group and by tag inside a sorted registry
+ *
+ * The index is built once, then selecting tests only costs a binary search
+ * per group named in a filter, or a lookup per tag, plus the selected tests
+ * themselves. The tag table is only built the first time a tag is asked for.
+ */
+class test_index
+{
+public:
+    explicit test_index(const vector<test_record>& records)
+        : _records(records)
+    {
+    }
+
+    /*!
+     * @brief Appends the position of every test of @p group to @p result
+     */
+    void find_group(std::string_view group, vector<size_t>& result) const
+    {
+        // Fixtures come first, then functions, both sorted by group
+        const auto first_function =
+            std::partition_point(_records.begin(), _records.end(),
+                                 [](const test_record& r)
+                                 { return is_fixture(r); });
+
+        append_range(_records.begin(), first_function, group, result);
+        append_range(first_function, _records.end(), group, result);
+    }
+
+    /*!
+     * @brief Position of every test tagged with @p tag
+     */
+    const vector<size_t>& find_tag(std::string_view tag)
+    {
+        if(!_tags_built)
+        {
+            for(size_t i = 0; i < _records.size(); i++)
+                for_each_tag(_records[i].tags, [&](std::string_view t)
+                             { _tags[t].push_back(i); });
+            _tags_built = true;
+        }
+
+        static const vector<size_t> none;
+        const auto                  it = _tags.find(tag);
+        return it == _tags.end() ? none : it->second;
+    }
+
+private:
+    using iterator = vector<test_record>::const_iterator;
+
+    void append_range(iterator         begin,
+                      iterator         end,
+                      std::string_view group,
+                      vector<size_t>&  result) const
+    {
+        const auto range = std::equal_range(
+            begin, end,
+            test_record {group, {}, nullptr, nullptr, nullptr, {}, {}, nullptr},
+            [](const test_record& a, const test_record& b)
+            { return a.group < b.group; });
+
+        for(auto it = range.first; it != range.second; ++it)
+            result.push_back(static_cast<size_t>(it - _records.begin()));
+    }
+
+    const vector<test_record>&                          _records;
+    std::unordered_map<std::string_view, vector<size_t>> _tags;
+    bool                                                _tags_built {false};
+};
+
+/*!
+ * @brief Group part of a filter, if it names a single group
+ */
+inline bool literal_group(std::string_view pattern, std::string_view& group)
+{
+    const auto dot = pattern.find('.');
+    group          = pattern.substr(0, dot);
+    return dot != std::string_view::npos &&
+           group.find_first_of("*?") == std::string_view::npos;
+}
+
+/*!
+ * @brief Sorts @p records and gathers the ones selected by @p run_options
+ *
+ * Tags are looked up first, then the groups of the filters when every filter
+ * names its group. Only when neither is possible does the selection go
+ * through every record.
+ */
+inline vector<test_case> select_tests(vector<test_record>& records,
+                                      const options&       run_options)
+{
+    // On stderr, so listing the tests still only writes their names to stdout
+    for(const auto& duplicate : sort_registry(records))
+        std::cerr << duplicate
+                  << " is registered more than once, only the first one runs\n";
+
+    test_index     index(records);
+    vector<size_t> candidates;
+    bool           narrowed {false};
+
+    if(!run_options.tags.empty())
+    {
+        for(const auto& tag : run_options.tags)
+        {
+            const auto& found = index.find_tag(tag);
+            candidates.insert(candidates.end(), found.begin(), found.end());
+        }
+        narrowed = true;
+    }
+    else if(!run_options.filters.empty())
+    {
+        std::string_view group;
+        narrowed = std::all_of(run_options.filters.begin(),
+                               run_options.filters.end(),
+                               [&](const string& filter)
+                               { return literal_group(filter, group); });
+
+        if(narrowed)
+            for(const auto& filter : run_options.filters)
+            {
+                literal_group(filter, group);
+                index.find_group(group, candidates);
+            }
+    }
+
+    if(narrowed)
+    {
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                         candidates.end());
+    }
+    else
+    {
+        candidates.resize(records.size());
+        for(size_t i = 0; i < candidates.size(); i++)
+            candidates[i] = i;
+    }
+
+    auto matches_any = [](const vector<string>& patterns,
+                          const test_record&    record)
+    {
+        return std::any_of(patterns.begin(), patterns.end(),
+                           [&](const string& pattern)
+                           { return matches(pattern, record); });
+    };
+
+    vector<test_case> tests;
+    for(auto i : candidates)
+    {
+        const auto& record = records[i];
+
+        if(!run_options.filters.empty() &&
+           !matches_any(run_options.filters, record))
+            continue;
+        if(matches_any(run_options.excludes, record))
+            continue;
+
+        tests.push_back({record, 0, 0});
+
+        if(record.timeout.count() == 0)
+            tests.back().record.timeout = run_options.timeout;
+    }
+
+    number_groups(tests);
+    return tests;
+}
+
+inline void append_json_string(string& json, std::string_view text)
+{
+    json += '"';
+    for(const char c : text)
+    {
+        if(c == '"' || c == '\\')
+        {
+            json += '\\';
+            json += c;
+        }
+        else if(static_cast<unsigned char>(c) < 0x20)
+        {
+            const char* digits = "0123456789abcdef";
+            json += "\\u00";
+            json += digits[(c >> 4) & 0xf];
+            json += digits[c & 0xf];
+        }
+        else
+            json += c;
+    }
+    json += '"';
+}
+
+/*!
+ * @brief Lists @p tests as a JSON document, without running anything
+ */
+inline string list_tests(const vector<test_case>& tests)
+{
+    string json;
+    json.reserve(64 * tests.size() + 16);
+    json += "{\"tests\":[";
+
+    for(size_t i = 0; i < tests.size(); i++)
+    {
+        const auto& record = tests[i].record;
+
+        json += i == 0 ? "\n" : ",\n";
+        json += "{\"group\":";
+        append_json_string(json, record.group);
+        json += ",\"name\":";
+        append_json_string(json, record.name);
+        json += ",\"fixture\":";
+        json += is_fixture(record) ? "true" : "false";
+        json += ",\"tags\":[";
+
+        bool first = true;
+        for_each_tag(record.tags,
+                     [&](std::string_view tag)
+                     {
+                         if(!first)
+                             json += ',';
+                         append_json_string(json, tag);
+                         first = false;
+                     });
+        json += "]}";
+    }
+    json += "\n]}\n";
+    return json;
+}
+
+/*!
+ * @brief Sorts the registry and gathers the fixtures and/or the functions
+ */
+inline vector<test_case> collect_tests(bool fixtures, bool functions)
+{
+    sort_registry(registry);
+
+    vector<test_case> tests;
+    for(const auto& record : registry)
+        if(is_fixture(record) ? fixtures : functions)
+            tests.push_back({record, 0, 0});
+
+    number_groups(tests);
+    return tests;
+}
+
+/*!
+ * @brief Watches the tests running in process, when one of them has a
+ * timeout
+ */
+inline watchdog* current_watchdog {nullptr};
+
+inline string full_name(const test_record& record)
+{
+    return string(record.group) + "." + string(record.name);
+}
+
+/*!
+ * @brief What happens when a test running in process times out
+ *
+ * A hung thread can't be stopped, so the run ends here. Everything already
+ * reported is written first, then which test hung, for how long.
+ */
+inline void abort_on_timeout(const string&             name,
+                             std::chrono::milliseconds elapsed)
+{
+    sink().flush();
+    std::cerr << "\n! Timeout : " << name << " is still running after "
+              << elapsed.count() << " ms, aborting\n";
+    std::cerr.flush();
+    std::abort();
+}
+
+/*!
+ * @brief Starts a watchdog for as long as the object lives, if one of
+ * @p tests has a timeout
+ */
+class watch_timeouts
+{
+public:
+    explicit watch_timeouts(const vector<test_case>& tests)
+    {
+        const bool needed =
+            std::any_of(tests.begin(), tests.end(), [](const test_case& test)
+                        { return test.record.timeout.count() > 0; });
+
+        if(needed)
+            current_watchdog = &_watchdog.emplace(&abort_on_timeout);
+    }
+
+    watch_timeouts(const watch_timeouts&)            = delete;
+    watch_timeouts& operator=(const watch_timeouts&) = delete;
+
+    ~watch_timeouts()
+    {
+        if(_watchdog)
+            current_watchdog = nullptr;
+    }
+
+private:
+    std::optional<watchdog> _watchdog;
+};
+
+/*!
+ * @brief Reports a check_throw, check_any_throw or check_no_throw that
+ * failed
+ */
+inline void log_throw_error(const char* file, int line, const char* what)
+{
+    if(silence_failure(file, line))
+        return;
+
+    failure_report report;
+
+    write_line("\n        ! Error : ", color::Red);
+    write("            * file :     ", color::Cyan);
+    write_line(file, color::Yellow);
+    write("            * line :     ", color::Cyan);
+    write_line(std::to_string(line), color::Magenta);
+    write("            * " + string(what) + " \n", color::Cyan);
+}
+
+inline void log_unexpected_exception(const string& what)
+{
+    failure_report report;
+
+    write_line("\n        ! Error : ", color::Red);
+    write("            * Unexpected exception : ", color::Cyan);
+    write_line(what, color::Magenta);
+}
+
+/*!
+ * @brief Seed of the run's properties, picked at random unless
+ * @ref property_seed was set. Never 0
+ */
+inline std::uint64_t run_seed()
+{
+    static const std::uint64_t random_seed = []()
+    {
+        std::random_device device;
+        std::uint64_t      seed {0};
+        while(seed == 0)
+            seed = device();
+        return seed;
+    }();
+
+    return property_seed != 0 ? property_seed : random_seed;
+}
+
+/*!
+ * @brief Seed of the @p index -th case of a property. Only depends on the
+ * property's name, so filtering tests doesn't change its cases
+ */
+inline std::uint64_t case_seed(std::uint64_t     seed,
+                               std::string_view name,
+                               size_t           index)
+{
+    std::uint64_t state = seed ^ stable_hash(name);
+    state += split_mix(state) * index;
+    return split_mix(state);
+}
+
+/*!
+ * @brief Threads running the cases of a property
+ */
+inline size_t property_threads()
+{
+    if(property_jobs != 0)
+        return property_jobs;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/*!
+ * @brief Runs @p body once, with its own failure context and its output
+ * thrown away
+ *
+ * @return True if a check failed or an exception leaked
+ */
+inline bool run_property_case(void (*body)(), choice_source& source)
+{
+    test_context context;
+    auto*        previous_context = std::exchange(current_context, &context);
+    auto*        previous_source  = std::exchange(current_source, &source);
+    bool         thrown {false};
+
+    string output;
+    {
+        capture_output capture(output);
+        try
+        {
+            body();
+        }
+        catch(...)
+        {
+            thrown = true;
+        }
+    }
+
+    current_source  = previous_source;
+    current_context = previous_context;
+    return thrown || context.errors != 0 || context.thread_errors != 0;
+}
+
+/*!
+ * @brief Index of the first of @p count cases of a property that fails,
+ * starting at @p first, or @p first + @p count if they all pass
+ *
+ * The cases run on @ref property_jobs threads. Every case has its own seed,
+ * so the result doesn't depend on the order they run in.
+ */
+inline size_t first_failing_case(void (*body)(),
+                                 std::uint64_t    seed,
+                                 std::string_view name,
+                                 size_t           first,
+                                 size_t           count)
+{
+    vector<char> failed(count, 0);
+
+    const auto run_case = [&](size_t i)
+    {
+        choice_source source(case_seed(seed, name, first + i));
+        failed[i] = run_property_case(body, source);
+    };
+
+    const auto jobs = property_threads();
+
+    if(jobs == 1 || count == 1)
+        for(size_t i = 0; i < count && (i == 0 || !failed[i - 1]); i++)
+            run_case(i);
+    else
+    {
+        vector<size_t> tasks(count);
+        for(size_t i = 0; i < count; i++)
+            tasks[i] = i;
+
+        work_stealing_pool pool(std::min(jobs, count), tasks, run_case);
+        pool.join();
+    }
+
+    return first + static_cast<size_t>(
+                       std::find(failed.begin(), failed.end(), 1) -
+                       failed.begin());
+}
+
+/*!
+ * @brief Runs the cases of the property @p name, made by @p body
+ *
+ * Cases run in batches, and the first failing one is shrunk to the simplest
+ * case that still fails. That case is then run again on the test's context,
+ * with every value it draws written before the failures it causes.
+ */
+inline void check_property(std::string_view name, void (*body)())
+{
+    constexpr size_t max_shrink_attempts = 10000;
+
+    const auto seed  = run_seed();
+    const auto batch = 64 * property_threads();
+
+    size_t failing = property_cases;
+    for(size_t first = 0; first < property_cases && failing == property_cases;
+        first += batch)
+    {
+        const auto count = std::min(batch, property_cases - first);
+        const auto found = first_failing_case(body, seed, name, first, count);
+        if(found < first + count)
+            failing = found;
+    }
+
+    if(failing == property_cases)
+        return;
+
+    choice_source original(case_seed(seed, name, failing));
+    run_property_case(body, original);
+
+    size_t shrinks {0};
+    auto   choices = shrink(
+        original.choices(),
+        [&](const std::vector<std::uint64_t>& candidate)
+        {
+            choice_source source(candidate);
+            return run_property_case(body, source);
+        },
+        max_shrink_attempts, shrinks);
+
+    {
+        failure_report report;
+
+        write_line("\n        ! Property failed : ", color::Red);
+        write("            * case :     ", color::Cyan);
+        write_line(std::to_string(failing + 1) + " of " +
+                       std::to_string(property_cases),
+                   color::Magenta);
+        write("            * seed :     ", color::Cyan);
+        write_line(std::to_string(seed) + " (--seed=" + std::to_string(seed) +
+                       ")",
+                   color::Magenta);
+        write("            * shrunk :   ", color::Cyan);
+        write_line(std::to_string(shrinks) + " times", color::Magenta);
+    }
+
+    choice_source simplest(std::move(choices));
+    simplest.on_draw = [](const string& value)
+    { write_line("            * drawn :    " + value, color::Yellow); };
+
+    auto* previous_source = std::exchange(current_source, &simplest);
+    try
+    {
+        body();
+    }
+    catch(const std::exception& e)
+    {
+        log_unexpected_exception(e.what());
+    }
+    catch(...)
+    {
+        log_unexpected_exception("unknown exception");
+    }
+    current_source = previous_source;
+}
+
+/*!
+ * @brief Writes what the threads of a test reported once its body is done,
+ * and returns all of its errors
+ */
+inline int close_context(test_context& context)
+{
+    for(auto& failure : context.thread_failures.take())
+        write_raw(std::move(failure));
+    log_silenced_failures(context);
+
+    return context.errors +
+           context.thread_errors.load(std::memory_order_relaxed);
+}
+
+/*!
+ * @brief Runs a single test with its own failure context
+ *
+ * Exceptions leaking from the test are reported as a failure of that test,
+ * so they can't take down the worker running it. Failures of the threads it
+ * started are written after its body.
+ *
+ * @param alone No other test runs in the process meanwhile, so threads that
+ *              weren't attached to a test report to this one
+ */
+inline void run_test(const test_case& test, test_result& result, bool alone)
+{
+    test_context context;
+    auto*        previous_context = std::exchange(current_context, &context);
+    auto*        previous_lone =
+        alone ? lone_context.exchange(&context, std::memory_order_acq_rel) :
+                nullptr;
+
+    size_t watched {0};
+    if(current_watchdog != nullptr && test.record.timeout.count() > 0)
+        watched =
+            current_watchdog->watch(full_name(test.record), test.record.timeout);
+
+    // Only the body is measured, not the fixture's set up and tear down
+    const auto run_body = [&](auto&& body)
+    {
+        context.allocations.start();
+        result.time        = function_time(body);
+        result.allocations = context.allocations.stats();
+    };
+
+    try
+    {
+        const auto& record = test.record;
+
+        if(record.make_fixture != nullptr)
+        {
+            auto fixture = record.make_fixture();
+            fixture->set_up();
+            run_body([&]() { fixture->run(); });
+            fixture->tear_down();
+        }
+        else if(record.function != nullptr)
+            run_body(record.function);
+        else
+            run_body(*record.callable);
+    }
+    catch(const std::exception& e)
+    {
+        log_unexpected_exception(e.what());
+    }
+    catch(...)
+    {
+        log_unexpected_exception("unknown exception");
+    }
+
+    if(watched != 0)
+        current_watchdog->release(watched);
+
+    if(alone)
+        lone_context.store(previous_lone, std::memory_order_release);
+
+    current_context = previous_context;
+    result.errors   = close_context(context);
+}
+
+/*!
+ * @brief Logs the end of a test and adds its errors to the total
+ *
+ * Must only be called from the thread that called @ref run_all
+ */
+inline void finish_test(const test_case& test, const test_result& result)
+{
+    if(result.errors == 0)
+        log_test_success(result.time, result.allocations);
+    else
+        failed_tests.push_back(string(test.record.group) +
+                               "::" + string(test.record.name));
+
+    error += result.errors;
+
+    if(history)
+        history->record(full_name(test.record), result.time,
+                        result.errors != 0);
+    if(fail_fast && result.errors != 0)
+        stopping = true;
+
+    if(reporters.empty())
+        return;
+
+    test_report report;
+    report.group       = test.record.group;
+    report.name        = test.record.name;
+    report.index       = test.index;
+    report.group_size  = test.group_size;
+    report.errors      = result.errors;
+    report.time        = result.time;
+    report.allocations = result.allocations;
+
+    for(auto& reporter : reporters)
+        reporter->test_finished(report);
+}
+
+/*!
+ * @brief Counts a test that never ran because of @ref fail_fast, and tells
+ * the reporters about it
+ *
+ * Must only be called from the thread that called @ref run_all, in the order
+ * the tests are reported
+ */
+inline void skip_test(const test_case& test)
+{
+    skipped_tests++;
+
+    if(reporters.empty())
+        return;
+
+    test_report report;
+    report.group      = test.record.group;
+    report.name       = test.record.name;
+    report.index      = test.index;
+    report.group_size = test.group_size;
+    report.skipped    = true;
+
+    for(auto& reporter : reporters)
+        reporter->test_finished(report);
+}
+
+inline void log_start_test(const test_case& test)
+{
+    const string group(test.record.group);
+
+    if(test.index == 1)
+        log_start_group(group, test.group_size);
+
+    log_start_test(string(test.record.name), group, test.group_size,
+                   test.index);
+}
+
+/*!
+ * @brief Sends everything about a test that ran elsewhere to the sink, in
+ * one block
+ */
+inline void report_test(const test_case& test, const test_result& result)
+{
+    string block;
+    {
+        capture_output capture(block);
+        log_start_test(test);
+        write_raw(result.output);
+        finish_test(test, result);
+    }
+    sink().write(std::move(block));
+}
+
+/*!
+ * @brief What the serial runner knows of a TEST_ASYNC
+ *
+ * Defined whatever the standard, so @ref run_tests_serially is the same in
+ * every translation unit, the runtime's included. Coroutine tests only run
+ * together through @p run_together, set by the translation unit defining
+ * them.
+ */
+struct async_body
+{
+    void (*run_together)(
+        const test_case* first,
+        const test_case* last,
+        const std::function<void(const test_case&, const test_result&)>&
+            report);
+};
+
+#ifdef CORGI_TEST_HAS_ASYNC
+
+/*!
+ * @brief Coroutine of a TEST_ASYNC
+ */
+struct async_test_body : async_body
+{
+    task<> (*start)();
+};
+
+/*!
+ * @brief Resumes the coroutine of a test, only counting the allocations it
+ * makes meanwhile
+ */
+inline void resume_test(async_state& state, std::coroutine_handle<> handle)
+{
+    auto* previous_context = std::exchange(current_context, state.context);
+    auto* previous_output  = std::exchange(output_buffer, state.output);
+    auto* previous_async   = std::exchange(current_async, &state);
+
+    if(state.context != nullptr)
+        state.context->allocations.resume();
+
+    handle.resume();
+
+    if(state.context != nullptr)
+        state.context->allocations.pause();
+
+    current_async   = previous_async;
+    output_buffer   = previous_output;
+    current_context = previous_context;
+}
+
+/*!
+ * @brief Makes @p loop the loop of the current thread for as long as the
+ * object lives
+ */
+class loop_scope
+{
+public:
+    explicit loop_scope(event_loop& loop)
+        : _previous(std::exchange(current_loop, &loop))
+    {
+    }
+
+    loop_scope(const loop_scope&)            = delete;
+    loop_scope& operator=(const loop_scope&) = delete;
+
+    ~loop_scope() { current_loop = _previous; }
+
+private:
+    event_loop* _previous;
+};
+
+inline const char* const stuck_coroutine =
+    "The coroutine was suspended without waiting on anything";
+
+/*!
+ * @brief Runs the coroutine of a TEST_ASYNC on a loop of its own, until it is
+ * done
+ *
+ * Used whenever the test doesn't run along other coroutine tests. Exceptions
+ * leaking from the coroutine are thrown again, for @ref run_test to report.
+ */
+inline void run_async_alone(const async_test_body& body)
+{
+    event_loop  loop;
+    loop_scope  scope(loop);
+    async_state state {current_context, output_buffer};
+    auto        coroutine = body.start();
+
+    loop.schedule(coroutine.handle(), &state);
+    while(!coroutine.handle().done() && loop.run_once())
+    {
+    }
+
+    if(!coroutine.handle().done())
+        throw std::logic_error(stuck_coroutine);
+    coroutine.handle().promise().take();
+}
+
+/*!
+ * @brief A TEST_ASYNC running along others
+ */
+struct async_run
+{
+    const test_case*                      test {nullptr};
+    test_context                          context;
+    string                                output;
+    async_state                           state;
+    std::optional<task<>>                 coroutine;
+    std::chrono::steady_clock::time_point start;
+    size_t                                watched {0};
+    bool                                  done {false};
+    test_result                           result;
+};
+
+/*!
+ * @brief Collects the result of @p run, whose coroutine is done, or will
+ * never be if @p stuck
+ */
+inline void finish_async_run(async_run& run, bool stuck)
+{
+    {
+        capture_output capture(run.output);
+        auto*          previous = std::exchange(current_context, &run.context);
+
+        try
+        {
+            if(stuck)
+                throw std::logic_error(stuck_coroutine);
+            run.coroutine->handle().promise().take();
+        }
+        catch(const std::exception& e)
+        {
+            log_unexpected_exception(e.what());
+        }
+        catch(...)
+        {
+            log_unexpected_exception("unknown exception");
+        }
+
+        run.coroutine.reset();
+        run.result.errors = close_context(run.context);
+        current_context   = previous;
+    }
+
+    if(run.watched != 0)
+        current_watchdog->release(run.watched);
+
+    run.result.time = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - run.start)
+                          .count();
+    run.result.allocations = run.context.allocations.stats();
+    run.result.output      = std::move(run.output);
+    run.done               = true;
+}
+
+/*!
+ * @brief Runs the TEST_ASYNC tests from @p first to @p last together, on one
+ * event loop
+ *
+ * Every test starts right away, and the loop resumes whichever can go on, so
+ * tests waiting on timers or I/O overlap on the calling thread. A test's time
+ * goes from its start to its end, suspensions included. Its allocations are
+ * only counted while its coroutine is created or resumed, so the tests
+ * running in between don't add to them.
+ *
+ * Finished tests are handed to @p report in their order.
+ */
+inline void run_async_tests(
+    const test_case* first,
+    const test_case* last,
+    const std::function<void(const test_case&, const test_result&)>& report)
+{
+    event_loop            loop;
+    loop_scope            scope(loop);
+    std::deque<async_run> runs;    // Never moves the states the loop points to
+
+    for(auto* test = first; test != last; test++)
+    {
+        auto& run = runs.emplace_back();
+        run.test  = test;
+        run.state = {&run.context, &run.output};
+        run.start = std::chrono::steady_clock::now();
+
+        if(current_watchdog != nullptr && test->record.timeout.count() > 0)
+            run.watched = current_watchdog->watch(full_name(test->record),
+                                                  test->record.timeout);
+
+        run.context.allocations.start();
+        run.coroutine.emplace(
+            static_cast<const async_test_body*>(test->record.async)->start());
+        run.context.allocations.pause();
+        loop.schedule(run.coroutine->handle(), &run.state);
+    }
+
+    for(size_t reported = 0; reported < runs.size();)
+    {
+        const bool waiting = loop.run_once();
+
+        for(auto& run : runs)
+            if(!run.done && (!waiting || run.coroutine->handle().done()))
+                finish_async_run(run, !waiting);
+
+        for(; reported < runs.size() && runs[reported].done; reported++)
+            report(*runs[reported].test, runs[reported].result);
+    }
+}
+
+#endif
+
+/*!
+ * @brief Runs the tests one after the other on the calling thread
+ *
+ * With @p buffered, the output of every test is handed to the sink in one
+ * block once the test is done. Otherwise every line reaches the sink as soon
+ * as it is written.
+ */
+inline void run_tests_serially(const vector<test_case>& tests, bool buffered)
+{
+    watch_timeouts watch(tests);
+
+    for(size_t i = 0; i < tests.size(); i++)
+    {
+        if(stopping)
+        {
+            for(; i < tests.size(); i++)
+                skip_test(tests[i]);
+            return;
+        }
+
+        if(tests[i].record.async != nullptr)
+        {
+            auto last = i;
+            while(last < tests.size() && tests[last].record.async != nullptr)
+                last++;
+
+            tests[i].record.async->run_together(
+                tests.data() + i, tests.data() + last, &report_test);
+            i = last - 1;
+            continue;
+        }
+
+        const auto& test = tests[i];
+        test_result result;
+        string      block;
+
+        if(buffered)
+        {
+            capture_output capture(block);
+            log_start_test(test);
+            run_test(test, result, true);
+            finish_test(test, result);
+        }
+        else
+        {
+            log_start_test(test);
+            run_test(test, result, true);
+            finish_test(test, result);
+        }
+
+        if(buffered)
+            sink().write(std::move(block));
+    }
+}
+
+/*!
+ * @brief Order in which @p tests start when several run at the same time :
+ * the longest ones according to the history first
+ */
+inline vector<size_t> dispatch_order(const vector<test_case>& tests)
+{
+    return longest_first(tests.size(),
+                         [&](size_t i) -> long long
+                         {
+                             const auto* found =
+                                 history ? history->find(
+                                               full_name(tests[i].record)) :
+                                           nullptr;
+                             return found != nullptr ? found->time : -1;
+                         });
+}
+
+/*!
+ * @brief Keeps the tests of the @p index shard out of @p count
+ *
+ * With a non empty @p last history, shards are balanced by the duration of
+ * their tests. A test missing from the history is deemed to take the mean
+ * duration, and every test at least a microsecond, so tests too quick to be
+ * measured are still spread between shards. Otherwise a test goes to the
+ * shard given by the hash of its name.
+ *
+ * Throws std::invalid_argument if @p index isn't lower than @p count
+ */
+inline void shard_tests(vector<test_case>& tests,
+                        size_t             index,
+                        size_t             count,
+                        const run_history* last)
+{
+    if(index >= count)
+        throw std::invalid_argument(
+            "The shard index must be lower than the shard count");
+
+    if(count == 1)
+        return;
+
+    vector<size_t> shards(tests.size());
+
+    if(last != nullptr && !last->empty())
+    {
+        vector<long long> times(tests.size(), -1);
+        long long         known_total {0};
+        long long         known {0};
+
+        for(size_t i = 0; i < tests.size(); i++)
+            if(const auto* found = last->find(full_name(tests[i].record)))
+            {
+                times[i] = std::max(found->time, 1ll);
+                known_total += times[i];
+                known++;
+            }
+
+        const long long mean = known > 0 ? known_total / known : 1;
+        for(auto& time : times)
+            if(time < 0)
+                time = std::max(mean, 1ll);
+
+        shards = balance_shards(times, count);
+    }
+    else
+        for(size_t i = 0; i < tests.size(); i++)
+            shards[i] = stable_hash(full_name(tests[i].record)) % count;
+
+    size_t kept {0};
+    for(size_t i = 0; i < tests.size(); i++)
+        if(shards[i] == index)
+            tests[kept++] = tests[i];
+
+    tests.resize(kept);
+    number_groups(tests);
+}
+
+/*!
+ * @brief Puts the groups holding a test that failed last time in front of
+ * the others, with their failed tests first, keeping their order otherwise
+ *
+ * Groups are moved whole, so each one is still reported once. Tests of the
+ * same group must be next to each other.
+ */
+inline void run_failed_first(vector<test_case>& tests, const run_history& last)
+{
+    const auto failed = [&](const test_case& test)
+    {
+        const auto* found = last.find(full_name(test.record));
+        return found != nullptr && found->failed;
+    };
+
+    vector<test_case> failed_groups;
+    vector<test_case> other_groups;
+
+    for(size_t begin = 0; begin < tests.size();)
+    {
+        size_t end = begin + 1;
+        while(end < tests.size() &&
+              same_group(tests[end].record, tests[begin].record))
+            end++;
+
+        const auto group_begin = tests.begin() + static_cast<long>(begin);
+        const auto group_end   = tests.begin() + static_cast<long>(end);
+
+        if(std::any_of(group_begin, group_end, failed))
+        {
+            std::stable_partition(group_begin, group_end, failed);
+            failed_groups.insert(failed_groups.end(), group_begin, group_end);
+        }
+        else
+            other_groups.insert(other_groups.end(), group_begin, group_end);
+
+        begin = end;
+    }
+
+    failed_groups.insert(failed_groups.end(), other_groups.begin(),
+                         other_groups.end());
+    tests = std::move(failed_groups);
+    number_groups(tests);
+}
+
+/*!
+ * @brief Runs the tests on a work stealing pool
+ *
+ * The output of every test is captured by the worker running it. The calling
+ * thread then waits for the tests in registration order, and prints them one
+ * after the other, so the log looks exactly like a serial run.
+ */
+inline void run_tests_in_parallel(const vector<test_case>& tests, unsigned jobs)
+{
+    enum : char
+    {
+        running,
+        finished,
+        skipped
+    };
+
+    vector<test_result>     results(tests.size());
+    vector<char>            done(tests.size(), running);
+    std::mutex              mutex;
+    std::condition_variable condition;
+
+    watch_timeouts     watch(tests);
+    work_stealing_pool pool(jobs, dispatch_order(tests),
+                            [&](size_t i)
+                            {
+                                const bool skip = stopping;
+                                if(!skip)
+                                {
+                                    capture_output capture(results[i].output);
+                                    run_test(tests[i], results[i]);
+                                }
+
+                                if(fail_fast && results[i].errors != 0)
+                                    stopping = true;
+
+                                {
+                                    std::lock_guard<std::mutex> lock(mutex);
+                                    done[i] = skip ? skipped : finished;
+                                }
+                                condition.notify_all();
+                            });
+
+    for(size_t i = 0; i < tests.size(); i++)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&]() { return done[i] != running; });
+        }
+
+        if(done[i] == skipped)
+        {
+            skip_test(tests[i]);
+            continue;
+        }
+
+        report_test(tests[i], results[i]);
+        results[i] = test_result();    // Releases the captured output early
+    }
+    pool.join();
+}
+
+#ifdef CORGI_TEST_HAS_FORK
+
+inline bool write_fd(int fd, const char* data, size_t size) noexcept
+{
+    while(size > 0)
+    {
+        const auto written = ::write(fd, data, size);
+
+        if(written < 0 && errno == EINTR)
+            continue;
+        if(written <= 0)
+            return false;
+
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+/*!
+ * @brief Where the output buffered by a crashing thread goes
+ */
+inline int crash_fd {1};
+
+/*!
+ * @brief Whether the pending blocks of the sink are written when crashing
+ *
+ * Forked children turn it off, the blocks they inherited belong to the parent
+ */
+inline bool flush_sink_on_crash {true};
+
+/*!
+ * @brief Signals the crash handlers catch
+ */
+inline constexpr int crash_signals[] {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+
+/*!
+ * @brief What the crash signals did before the current @ref crash_handlers,
+ * one action per signal of @ref crash_signals
+ */
+inline const struct sigaction* previous_crash_actions {nullptr};
+
+/*!
+ * @brief Writes what was still buffered before letting the process die
+ *
+ * Pending blocks of the sink come first, then what the crashing thread
+ * buffered for its current test. The signal then goes to what handled it
+ * before the run.
+ */
+inline void flush_on_crash(int signal_number)
+{
+    if(flush_sink_on_crash && current_sink != nullptr)
+        current_sink->emergency_flush();
+
+    if(output_buffer != nullptr)
+        write_fd(crash_fd, output_buffer->data(), output_buffer->size());
+
+    for(size_t i = 0; i < std::size(crash_signals); i++)
+        if(crash_signals[i] == signal_number &&
+           previous_crash_actions != nullptr)
+            sigaction(signal_number, &previous_crash_actions[i], nullptr);
+
+    std::raise(signal_number);
+}
+
+/*!
+ * @brief Catches the crash signals for as long as the object lives, then
+ * gives them back to their previous handlers
+ */
+class crash_handlers
+{
+public:
+    crash_handlers()
+    {
+        struct sigaction action
+        {
+        };
+        action.sa_handler = &flush_on_crash;
+        action.sa_flags   = static_cast<int>(SA_RESETHAND);
+        sigemptyset(&action.sa_mask);
+
+        for(size_t i = 0; i < std::size(crash_signals); i++)
+            sigaction(crash_signals[i], &action, &_previous[i]);
+
+        _outer = std::exchange(previous_crash_actions, _previous);
+    }
+
+    crash_handlers(const crash_handlers&)            = delete;
+    crash_handlers& operator=(const crash_handlers&) = delete;
+
+    ~crash_handlers()
+    {
+        previous_crash_actions = _outer;
+
+        for(size_t i = 0; i < std::size(crash_signals); i++)
+            sigaction(crash_signals[i], &_previous[i], nullptr);
+    }
+
+private:
+    struct sigaction        _previous[std::size(crash_signals)] {};
+    const struct sigaction* _outer {nullptr};
+};
+
+/*!
+ * @brief Runs @p test in the current process and sends its output and result
+ * through @p fd
+ *
+ * The output is buffered like any other test, and written by the crash
+ * handler if the test dies. The result comes last, after a '\0', so the
+ * parent knows the test wasn't interrupted if it finds it.
+ */
+[[noreturn]] inline void run_child(const test_case& test, int fd)
+{
+    std::signal(SIGPIPE, SIG_IGN);
+    crash_fd            = fd;
+    flush_sink_on_crash = false;
+
+    string      output;
+    test_result result;
+    {
+        capture_output capture(output);
+        run_test(test, result, true);
+        output += '\0' + std::to_string(result.errors) + ' ' +
+                  std::to_string(result.time) + ' ' +
+                  std::to_string(result.allocations.allocations) + ' ' +
+                  std::to_string(result.allocations.bytes) + ' ' +
+                  std::to_string(result.allocations.peak_bytes);
+    }
+
+    write_fd(fd, output.data(), output.size());
+    ::close(fd);
+    _exit(0);    // Static destructors belong to the parent
+}
+
+/*!
+ * @brief Turns what a child sent and how it ended into a test result
+ * @param timed_out The timeout of the test, if the child was killed because
+ *                  of it
+ */
+inline test_result read_child_result(string                    data,
+                                     int                       status,
+                                     std::chrono::milliseconds timed_out = {})
+{
+    test_result result;
+
+    const auto trailer = data.rfind('\0');
+
+    if(WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+       trailer != string::npos)
+    {
+        std::istringstream stream(data.substr(trailer + 1));
+        stream >> result.errors >> result.time >>
+            result.allocations.allocations >> result.allocations.bytes >>
+            result.allocations.peak_bytes;
+        data.resize(trailer);
+        result.output = std::move(data);
+        return result;
+    }
+
+    if(trailer != string::npos)
+        data.resize(trailer);
+
+    capture_output capture(data);
+    write_line("\n        ! Error : ", color::Red);
+
+    if(timed_out.count() > 0)
+    {
+        write("            * Timed out after : ", color::Cyan);
+        write_line(std::to_string(timed_out.count()) + " ms", color::Magenta);
+    }
+    else if(WIFSIGNALED(status))
+    {
+        write("            * Crashed with signal : ", color::Cyan);
+        write_line(std::to_string(WTERMSIG(status)) + " (" +
+                       strsignal(WTERMSIG(status)) + ")",
+                   color::Magenta);
+    }
+    else
+    {
+        write("            * Exited before the end of the test with code : ",
+              color::Cyan);
+        write_line(std::to_string(WIFEXITED(status) ? WEXITSTATUS(status) : -1),
+                   color::Magenta);
+    }
+
+    result.output = data;
+    result.errors = 1;
+    return result;
+}
+
+/*!
+ * @brief Runs every test inside a forked child process
+ *
+ * At most @p jobs children are alive at the same time. Their output comes back
+ * through a pipe, and @p on_result is called for every test in the same order
+ * as @p tests, no matter in which order the children end.
+ *
+ * A child running longer than the timeout of its test receives SIGABRT, so
+ * it writes what its test printed, then SIGKILL if it is still alive a
+ * moment later. Its test fails and the run goes on.
+ *
+ * Children start longest first, according to the history. Once @ref stopping
+ * is set, no other child starts, and the tests they would have run are
+ * skipped.
+ *
+ * @param stop_on_failure   Sets @ref stopping as soon as a child fails,
+ *                          instead of waiting for its turn to be reported
+ */
+template<class Callback>
+void run_isolated(const vector<test_case>& tests,
+                  unsigned                 jobs,
+                  Callback&&               on_result,
+                  bool                     stop_on_failure = false)
+{
+    using clock = std::chrono::steady_clock;
+
+    struct child
+    {
+        pid_t             pid;
+        int               fd;
+        size_t            test;
+        string            data;
+        clock::time_point deadline;
+        bool              timed_out;
+    };
+
+    const auto kill_delay = std::chrono::milliseconds(500);
+
+    enum : char
+    {
+        running,
+        finished,
+        skipped
+    };
+
+    const auto order = dispatch_order(tests);
+
+    vector<test_result> results(tests.size());
+    vector<char>        done(tests.size(), running);
+    vector<child>       children;
+    size_t              next_to_start {0};
+    size_t              next_to_report {0};
+
+    while(next_to_report < tests.size())
+    {
+        while(stopping && next_to_start < tests.size())
+            done[order[next_to_start++]] = skipped;
+
+        while(children.size() < jobs && next_to_start < tests.size())
+        {
+            const auto test = order[next_to_start++];
+
+            int fds[2];
+            if(::pipe(fds) != 0)
+                throw std::runtime_error("Could not create a pipe");
+
+            const pid_t pid = ::fork();
+
+            if(pid < 0)
+                throw std::runtime_error("Could not fork the test process");
+
+            if(pid == 0)
+            {
+                ::close(fds[0]);
+                for(auto& other : children)
+                    ::close(other.fd);
+                run_child(tests[test], fds[1]);
+            }
+
+            ::close(fds[1]);
+
+            const auto timeout  = tests[test].record.timeout;
+            const auto deadline = timeout.count() > 0 ?
+                                      clock::now() + timeout :
+                                      clock::time_point::max();
+            children.push_back({pid, fds[0], test, {}, deadline, false});
+        }
+
+        vector<pollfd> fds;
+        auto           next_deadline = clock::time_point::max();
+        for(const auto& c : children)
+        {
+            fds.push_back({c.fd, POLLIN, 0});
+            next_deadline = std::min(next_deadline, c.deadline);
+        }
+
+        int wait {-1};    // Milliseconds until the closest deadline
+        if(next_deadline != clock::time_point::max())
+        {
+            const auto left = std::chrono::ceil<std::chrono::milliseconds>(
+                next_deadline - clock::now());
+            wait = static_cast<int>(std::max<long long>(0, left.count()));
+        }
+
+        // Nothing to wait for once fail fast skipped the tests left to start
+        if(!fds.empty() && ::poll(fds.data(), fds.size(), wait) < 0 &&
+           errno != EINTR)
+            throw std::runtime_error("Could not poll the test processes");
+
+        const auto now = clock::now();
+        for(auto& c : children)
+        {
+            if(now < c.deadline)
+                continue;
+
+            if(!c.timed_out)
+            {
+                ::kill(c.pid, SIGABRT);
+                c.timed_out = true;
+                c.deadline  = now + kill_delay;
+            }
+            else
+            {
+                ::kill(c.pid, SIGKILL);
+                c.deadline = clock::time_point::max();
+            }
+        }
+
+        for(size_t i = fds.size(); i-- > 0;)
+        {
+            if(fds[i].revents == 0)
+                continue;
+
+            auto&      c = children[i];
+            char       buffer[4096];
+            const auto size = ::read(c.fd, buffer, sizeof(buffer));
+
+            if(size > 0)
+            {
+                c.data.append(buffer, static_cast<size_t>(size));
+                continue;
+            }
+            if(size < 0 && errno == EINTR)
+                continue;
+
+            ::close(c.fd);
+
+            int status {0};
+            while(::waitpid(c.pid, &status, 0) < 0 && errno == EINTR)
+            {
+            }
+
+            results[c.test] = read_child_result(
+                std::move(c.data), status,
+                c.timed_out ? tests[c.test].record.timeout :
+                              std::chrono::milliseconds(0));
+            done[c.test]    = finished;
+
+            if(stop_on_failure && results[c.test].errors != 0)
+                stopping = true;
+
+            children.erase(children.begin() + static_cast<long>(i));
+        }
+
+        while(next_to_report < tests.size() &&
+              done[next_to_report] != running)
+        {
+            if(done[next_to_report] == skipped)
+                skip_test(tests[next_to_report]);
+            else
+                on_result(next_to_report, results[next_to_report]);
+
+            results[next_to_report++] = test_result();
+        }
+    }
+}
+
+#endif
+
+inline void run_tests(const vector<test_case>& tests,
+                      const options&            run_options)
+{
+    unsigned jobs = run_options.jobs;
+
+    if(jobs == 0)
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+
+    if(run_options.isolate)
+    {
+#ifdef CORGI_TEST_HAS_FORK
+        run_isolated(
+            tests, jobs,
+            [&](size_t i, const test_result& result)
+            { report_test(tests[i], result); },
+            run_options.fail_fast);
+        return;
+#else
+        std::cerr << "Test isolation isn't available on this platform, "
+                     "running the tests in process\n";
+#endif
+    }
+
+    if(jobs == 1 || tests.size() < 2)
+        run_tests_serially(tests, !run_options.sync_output);
+    else
+        run_tests_in_parallel(tests, jobs);
+}
+
+/*!
+ * @brief Checks if @p arg is the @p name option and extracts its value
+ *
+ * The value is either glued to the option with an '=', or is the next
+ * argument, in which case @p i is moved past it.
+ */
+inline bool
+parse_value(int argc, char** argv, int& i, std::string_view name, string& value)
+{
+    const std::string_view arg(argv[i]);
+
+    if(arg.substr(0, name.size()) != name)
+        return false;
+
+    if(arg.size() == name.size())
+    {
+        if(i + 1 >= argc)
+            throw std::invalid_argument("Missing value for " + string(name));
+        value = argv[++i];
+        return true;
+    }
+
+    if(arg[name.size()] != '=')
+        return false;
+
+    value = string(arg.substr(name.size() + 1));
+    return true;
+}
+
+inline void split(const string& text, char separator, vector<string>& result)
+{
+    size_t begin {0};
+
+    for(;;)
+    {
+        const auto end = text.find(separator, begin);
+
+        if(end != begin && begin < text.size())
+            result.push_back(text.substr(begin, end - begin));
+        if(end == string::npos)
+            return;
+        begin = end + 1;
+    }
+}
+
+/*!
+ * @brief Reads the value of the @p name option, rejecting anything that
+ * isn't a number between 0 and @p maximum
+ */
+inline unsigned
+parse_unsigned(const string& name,
+               const string& value,
+               unsigned      maximum = std::numeric_limits<unsigned>::max())
+{
+    try
+    {
+        size_t     end {0};
+        const auto number = std::stoul(value, &end);
+
+        if(end == value.size() && value.find('-') == string::npos &&
+           number <= maximum)
+            return static_cast<unsigned>(number);
+    }
+    catch(const std::exception&)
+    {
+    }
+    throw std::invalid_argument("Invalid value for " + name + " : " + value);
+}
+}    // namespace detail
+
+/*!
+ * @brief  Builds the options from the command line arguments
+ *
+ * Supported arguments :
+ *  --jobs N, -j N  Runs up to N tests at the same time (0 : one per core)
+ *  --isolate       Runs every test inside its own child process
+ *  --sync-output   Writes the output synchronously, as it comes
+ *  --filter=P      Only runs the tests whose "group.name" matches one of the
+ *                  ':' separated patterns. '*' and '?' are wildcards
+ *  --exclude=P     Skips the tests matching one of the patterns
+ *  --tag=T         Only runs the tests having one of the ',' separated tags
+ *  --list          Lists the selected tests as JSON without running them
+ *  --timeout=MS    Longest a test without its own timeout can run
+ *  --history=FILE  Keeps the duration and outcome of every test in FILE
+ *  --failed-first  Runs the tests that failed last time first
+ *  --fail-fast     Stops starting tests once one failed
+ *  --max-reported-failures=N   Failures of a test reported in full (10),
+ *                  the next ones are only counted. 0 reports them all
+ *  --property-cases=N  Cases every PROPERTY runs (100)
+ *  --property-jobs=N   Threads running the cases of a property (0 : one
+ *                  per core)
+ *  --seed=S        Seed of the property cases, random by default
+ *  --shard-index=I, --shard-count=N    Only runs the I-th of N parts of the
+ *                  tests, balanced by duration when there is a history
+ *  --benchmark-warmup=MS       Time spent warming up every benchmark
+ *  --benchmark-sample-time=MS  Target duration of a benchmark sample
+ *  --hardware-counters         Reads the CPU counters around benchmarks
+ *  --json-report=FILE  Streams the results to FILE as JSON lines
+ *  --junit-report=FILE Streams the results to FILE as JUnit XML
+ *  --baseline=FILE     Fails if a benchmark got slower than in FILE
+ *  --save-baseline=FILE        Saves the benchmark results into FILE
+ *  --regression-tolerance=PCT  Slowdown allowed against the baseline (10)
+ *
+ * Throws std::invalid_argument if an argument isn't recognized
+ */
+inline options parse_options(int argc, char** argv)
+{
+    options result;
+
+    for(int i = 1; i < argc; i++)
+    {
+        string value;
+
+        if(detail::parse_value(argc, argv, i, "--jobs", value) ||
+           detail::parse_value(argc, argv, i, "-j", value))
+            result.jobs = detail::parse_unsigned("--jobs", value);
+        else if(std::string_view(argv[i]) == "--isolate")
+            result.isolate = true;
+        else if(std::string_view(argv[i]) == "--sync-output")
+            result.sync_output = true;
+        else if(detail::parse_value(argc, argv, i, "--filter", value))
+            detail::split(value, ':', result.filters);
+        else if(detail::parse_value(argc, argv, i, "--exclude", value))
+            detail::split(value, ':', result.excludes);
+        else if(detail::parse_value(argc, argv, i, "--tag", value))
+            detail::split(value, ',', result.tags);
+        else if(std::string_view(argv[i]) == "--list")
+            result.list = true;
+        else if(detail::parse_value(argc, argv, i, "--history", value))
+            result.history = value;
+        else if(std::string_view(argv[i]) == "--failed-first")
+            result.failed_first = true;
+        else if(std::string_view(argv[i]) == "--fail-fast")
+            result.fail_fast = true;
+        else if(detail::parse_value(argc, argv, i, "--max-reported-failures",
+                                    value))
+            result.reported_failures = static_cast<int>(detail::parse_unsigned(
+                "--max-reported-failures", value,
+                std::numeric_limits<int>::max()));
+        else if(detail::parse_value(argc, argv, i, "--property-cases", value))
+            result.property_cases =
+                detail::parse_unsigned("--property-cases", value);
+        else if(detail::parse_value(argc, argv, i, "--property-jobs", value))
+            result.property_jobs =
+                detail::parse_unsigned("--property-jobs", value);
+        else if(detail::parse_value(argc, argv, i, "--seed", value))
+            result.seed = detail::parse_unsigned("--seed", value);
+        else if(detail::parse_value(argc, argv, i, "--shard-index", value))
+            result.shard_index = detail::parse_unsigned("--shard-index", value);
+        else if(detail::parse_value(argc, argv, i, "--shard-count", value))
+            result.shard_count = detail::parse_unsigned("--shard-count", value);
+        else if(detail::parse_value(argc, argv, i, "--benchmark-warmup", value))
+            result.benchmark.warmup_time = std::chrono::milliseconds(
+                detail::parse_unsigned("--benchmark-warmup", value));
+        else if(detail::parse_value(argc, argv, i, "--benchmark-sample-time",
+                                    value))
+            result.benchmark.sample_time = std::chrono::milliseconds(
+                detail::parse_unsigned("--benchmark-sample-time", value));
+        else if(std::string_view(argv[i]) == "--hardware-counters")
+            result.benchmark.hardware_counters = true;
+        else if(detail::parse_value(argc, argv, i, "--json-report", value))
+            result.json_report = value;
+        else if(detail::parse_value(argc, argv, i, "--timeout", value))
+            result.timeout = std::chrono::milliseconds(
+                detail::parse_unsigned("--timeout", value));
+        else if(detail::parse_value(argc, argv, i, "--junit-report", value))
+            result.junit_report = value;
+        else if(detail::parse_value(argc, argv, i, "--baseline", value))
+            result.compare_baseline = value;
+        else if(detail::parse_value(argc, argv, i, "--save-baseline", value))
+            result.save_baseline = value;
+        else if(detail::parse_value(argc, argv, i, "--regression-tolerance",
+                                    value))
+            result.regression_tolerance =
+                detail::parse_unsigned("--regression-tolerance", value) /
+                100.0;
+        else
+            throw std::invalid_argument("Unknown option : " + string(argv[i]));
+    }
+    return result;
+}
+
+inline void run_fixtures()
+{
+    detail::run_tests_serially(detail::collect_tests(true, false), false);
+}
+
+inline void run_functions()
+{
+    detail::run_tests_serially(detail::collect_tests(false, true), false);
+}
+
+/*!
+ * @brief Replaces the sink receiving the output of the framework
+ */
+inline void set_output_sink(std::unique_ptr<output_sink> sink)
+{
+    detail::sink().flush();
+    detail::current_sink = std::move(sink);
+}
+
+/*!
+ * @brief A function compared by a benchmark
+ */
+struct benchmark_candidate
+{
+    /*!
+     * @param function  Any callable taking no parameter. Use
+     *                  @ref do_not_optimize on what it computes
+     */
+    template<class Function>
+    benchmark_candidate(std::string name, Function function)
+        : name(std::move(name))
+        , run_batch(detail::make_batch_function(std::move(function)))
+    {
+    }
+
+    std::string            name;
+    detail::batch_function run_batch;
+};
+
+/*!
+ * @brief Compares any number of functions doing the same work
+ */
+struct benchmark
+{
+    benchmark(std::string                      name,
+              int                              repetition,
+              std::vector<benchmark_candidate> candidates)
+        : candidates(std::move(candidates))
+        , repetition(repetition)
+        , name(std::move(name))
+    {
+    }
+
+    benchmark(std::function<void()> first_function,
+              std::string           first_function_name,
+              std::function<void()> second_function,
+              std::string           second_function_name,
+              int                   repetition,
+              std::string           name)
+        : benchmark(std::move(name), repetition,
+                    {{std::move(first_function_name), std::move(first_function)},
+                     {std::move(second_function_name),
+                      std::move(second_function)}})
+    {
+    }
+
+    std::vector<benchmark_candidate> candidates;
+    int                              repetition;
+    std::string                      name;
+
+    /*!
+     * @brief How much slower than the baseline a candidate can get before
+     * failing the run, 0.1 for 10%. Uses @ref options::regression_tolerance
+     * when empty
+     */
+    std::optional<double> tolerance;
+};
+
+static inline std::vector<benchmark> benchmarks;
+
+/*!
+ * @brief Registers a benchmark comparing every function of @p candidates
+ * @param repetition    How many samples are measured for every candidate
+ * @param tolerance     Slowdown allowed against a baseline, see
+ *                      @ref benchmark::tolerance
+ */
+inline void add_benchmark(std::string                      name,
+                          int                              repetition,
+                          std::vector<benchmark_candidate> candidates,
+                          std::optional<double>            tolerance = {})
+{
+    benchmarks.emplace_back(std::move(name), repetition, std::move(candidates));
+    benchmarks.back().tolerance = tolerance;
+}
+
+/*!
+ * @brief Registers a benchmark comparing two callables of any type
+ */
+template<class First, class Second>
+void add_benchmark(std::string        name,
+                   int                repetition,
+                   First              first_function,
+                   const std::string& first_function_name,
+                   Second             second_function,
+                   const std::string& second_function_name)
+{
+    add_benchmark(std::move(name), repetition,
+                  {{first_function_name, std::move(first_function)},
+                   {second_function_name, std::move(second_function)}});
+}
+
+/*!
+ * @brief Sizes a range benchmark runs with
+ *
+ * Starts at @ref first, and multiplies the size by @ref multiplier until
+ * reaching @ref last, which is always part of the range
+ */
+struct benchmark_range
+{
+    size_t first {1};
+    size_t last {1};
+    size_t multiplier {8};
+
+    vector<size_t> sizes() const
+    {
+        vector<size_t> result;
+
+        for(size_t size = std::max<size_t>(first, 1); size < last;
+            size *= std::max<size_t>(multiplier, 2))
+            result.push_back(size);
+
+        result.push_back(std::max<size_t>(last, 1));
+        return result;
+    }
+};
+
+/*!
+ * @brief Measures a single function over a range of input sizes, to find
+ * out how its time grows with the size
+ */
+struct range_benchmark
+{
+    std::string     name;
+    int             repetition {0};
+    benchmark_range range;
+
+    /*!
+     * @brief Runs the setup for a size, and returns the timed part
+     */
+    std::function<detail::batch_function(size_t)> prepare;
+};
+
+inline std::vector<range_benchmark> range_benchmarks;
+
+/*!
+ * @brief Registers a benchmark running @p function for every size of
+ * @p range
+ *
+ * For every size, @p setup is called once with the size, outside of the
+ * timing, and what it returns is given by reference to every call of
+ * @p function. Anything @p function changes in it stays changed for the next
+ * call, so a function modifying its input must work on a copy.
+ *
+ * @code
+ * corgi::test::add_range_benchmark(
+ *     "std::sort", 10, {1 << 10, 1 << 20, 4},
+ *     [](size_t size) { return random_vector(size); },
+ *     [](const std::vector<int>& values)
+ *     {
+ *         auto copy = values;
+ *         std::sort(copy.begin(), copy.end());
+ *         corgi::test::do_not_optimize(copy.data());
+ *     });
+ * @endcode
+ */
+template<class Setup, class Function>
+void add_range_benchmark(std::string     name,
+                         int             repetition,
+                         benchmark_range range,
+                         Setup           setup,
+                         Function        function)
+{
+    using state = std::decay_t<std::invoke_result_t<Setup&, size_t>>;
+
+    range_benchmark benchmark;
+    benchmark.name       = std::move(name);
+    benchmark.repetition = repetition;
+    benchmark.range      = range;
+    benchmark.prepare    = [setup, function](size_t size) mutable
+    {
+        auto input = std::make_shared<state>(setup(size));
+        return detail::make_batch_function([input, function]() mutable
+                                           { function(*input); });
+    };
+    range_benchmarks.push_back(std::move(benchmark));
+}
+
+namespace detail
+{
+/*!
+ * @brief Times a batch of calls on one of the threads of a threaded
+ * benchmark, given the index of the thread and the number of calls
+ */
+using thread_batch_function = std::function<double(size_t, size_t)>;
+}    // namespace detail
+
+/*!
+ * @brief Runs the same function on more and more threads at once, to see
+ * how its throughput scales
+ */
+struct threaded_benchmark
+{
+    std::string name;
+    int         repetition {0};
+    size_t      max_threads {0};    // 0 for one per hardware thread
+
+    detail::thread_batch_function run_batch;
+
+    /*!
+     * @brief Thread counts measured : 1, 2, 4, ... up to @ref max_threads,
+     * which is always measured
+     */
+    vector<size_t> thread_counts() const
+    {
+        size_t last = max_threads;
+        if(last == 0)
+            last = std::max(1u, std::thread::hardware_concurrency());
+
+        vector<size_t> result;
+        for(size_t count = 1; count < last; count *= 2)
+            result.push_back(count);
+        result.push_back(last);
+        return result;
+    }
+};
+
+inline std::vector<threaded_benchmark> threaded_benchmarks;
+
+/*!
+ * @brief Registers a benchmark calling @p function concurrently from 1, 2,
+ * 4, ... @p max_threads threads
+ *
+ * @p function is called with the index of the thread running it, from 0, if
+ * it can take it, and with nothing otherwise. Every thread calls its own copy
+ * of @p function, so what they share must be captured by reference.
+ *
+ * @param max_threads   Most threads used at once, 0 for one per hardware
+ *                      thread
+ */
+template<class Function>
+void add_threaded_benchmark(std::string name,
+                            int         repetition,
+                            size_t      max_threads,
+                            Function    function)
+{
+    threaded_benchmark benchmark;
+    benchmark.name        = std::move(name);
+    benchmark.repetition  = repetition;
+    benchmark.max_threads = max_threads;
+    benchmark.run_batch   = [function](size_t thread, size_t iterations)
+    {
+        if constexpr(std::is_invocable_v<Function&, size_t>)
+        {
+            auto call = [local = function, thread]() mutable
+            { local(thread); };
+            return detail::time_batch(call, iterations);
+        }
+        else
+        {
+            auto local = function;
+            return detail::time_batch(local, iterations);
+        }
+    };
+    threaded_benchmarks.push_back(std::move(benchmark));
+}
+
+inline void add_test(const std::string&    group_name,
+                     const std::string&    test_name,
+                     std::function<void()> lambda)
+{
+    using namespace corgi::test::detail;
+
+    dynamic_names.push_back(group_name);
+    const std::string_view group = dynamic_names.back();
+    dynamic_names.push_back(test_name);
+    const std::string_view name = dynamic_names.back();
+    dynamic_tests.push_back(std::move(lambda));
+
+    registry.push_back({group, name, nullptr, nullptr, &dynamic_tests.back(),
+                        {}, {}, nullptr});
+}
+
+/*!
+ * @brief Measures of a benchmarked function
+ *
+ * Every time is the time of a single call, in nanoseconds, except for
+ * @ref total_time
+ */
+struct benchmark_function_result
+{
+    double total_time {0.0};    // Time spent in every measured call
+    double min_time {0.0};
+    double max_time {0.0};
+    double mean_time {0.0};
+    double median_time {0.0};
+    double p90_time {0.0};
+    double p99_time {0.0};
+    double stddev {0.0};
+    double mad {0.0};    // Median absolute deviation
+
+    size_t outliers {0};
+    size_t iterations {0};    // Calls per sample
+
+    vector<double> samples;    // Time of a call, for every sample
+
+    /*!
+     * @brief Hardware events per call, when they were asked for and available
+     */
+    hardware_counters counters;
+
+    // Per call, only counted when allocations are tracked
+    double allocations {0.0};
+    double allocated_bytes {0.0};
+};
+
+/*!
+ * @brief How a candidate compares to the fastest one
+ */
+struct benchmark_comparison
+{
+    size_t candidate {0};
+
+    /*!
+     * @brief How many times slower than the fastest candidate, with its 95%
+     * confidence interval
+     */
+    detail::ratio_interval slowdown;
+};
+
+struct benchmark_result
+{
+    vector<benchmark_function_result> results;    // Same order as candidates
+
+    size_t fastest {0};    // Candidate with the lowest median
+
+    /*!
+     * @brief Every other candidate, compared to the fastest one
+     */
+    vector<benchmark_comparison> comparisons;
+};
+
+namespace detail
+{
+/*!
+ * @brief Runs @p function for the warmup time, and figures out how many
+ * calls a sample needs to last the sample time
+ *
+ * The warmup runs batches of doubling size, the last one gives the estimate
+ */
+inline size_t calibrate(const batch_function&    run_batch,
+                        const benchmark_settings& settings)
+{
+    const auto warmup = static_cast<double>(settings.warmup_time.count());
+    const auto target = static_cast<double>(settings.sample_time.count());
+
+    size_t iterations {1};
+    double elapsed {0.0};
+    double batch_time {0.0};
+
+    for(;;)
+    {
+        batch_time = run_batch(iterations);
+        elapsed += batch_time;
+
+        if(elapsed >= warmup && batch_time > 0.0)
+            break;
+        if(iterations >= (size_t(1) << 40))
+            break;
+        iterations *= 2;
+    }
+
+    const double per_call = batch_time / static_cast<double>(iterations);
+    if(per_call <= 0.0)
+        return iterations;
+
+    return std::max<size_t>(1, static_cast<size_t>(target / per_call));
+}
+
+/*!
+ * @brief Formats a time in nanoseconds with the most readable unit
+ */
+inline string format_time(double nanoseconds)
+{
+    const char* unit  = "ns";
+    double      value = nanoseconds;
+
+    if(std::abs(value) >= 1e9)
+    {
+        value /= 1e9;
+        unit = "s";
+    }
+    else if(std::abs(value) >= 1e6)
+    {
+        value /= 1e6;
+        unit = "ms";
+    }
+    else if(std::abs(value) >= 1e3)
+    {
+        value /= 1e3;
+        unit = "us";
+    }
+
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%.3f %s", value, unit);
+    return buffer;
+}
+
+inline void log_benchmark_function_result(const benchmark_function_result& r)
+{
+    write_line("\t* Samples : " + std::to_string(r.samples.size()) + " x " +
+                   std::to_string(r.iterations) + " calls",
+               color::Magenta);
+    write_line("\t* Median : " + format_time(r.median_time) +
+                   " (p90 : " + format_time(r.p90_time) +
+                   ", p99 : " + format_time(r.p99_time) + ")",
+               color::Magenta);
+    write_line("\t* Mean : " + format_time(r.mean_time) +
+                   " (stddev : " + format_time(r.stddev) + ")",
+               color::Magenta);
+    write_line("\t* MAD : " + format_time(r.mad), color::Magenta);
+    write_line("\t* Min Time : " + format_time(r.min_time) +
+                   ", Max Time : " + format_time(r.max_time),
+               color::Magenta);
+    write_line("\t* Total Time : " + format_time(r.total_time),
+               color::Magenta);
+
+    if(r.outliers > 0)
+        write_line("\t* Outliers : " + std::to_string(r.outliers) + " of " +
+                       std::to_string(r.samples.size()) + " samples",
+                   color::Yellow);
+
+    if(allocation_tracking)
+    {
+        char buffer[96];
+        std::snprintf(buffer, sizeof(buffer),
+                      "\t* Allocations : %.2f per call (%.1f bytes)",
+                      r.allocations, r.allocated_bytes);
+        write_line(buffer, color::Magenta);
+    }
+}
+
+inline void log_hardware_counters(const hardware_counters& counters)
+{
+    if(!counters.available())
+    {
+        write_line("\t* Hardware counters unavailable, timings only",
+                   color::Yellow);
+        return;
+    }
+
+    string line = "\t* Per call :";
+    auto   add  = [&](const char* name, const std::optional<double>& value)
+    {
+        if(!value)
+            return;
+
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), " %.2f %s,", *value, name);
+        line += buffer;
+    };
+
+    add("cycles", counters.cycles);
+    add("instructions", counters.instructions);
+    add("IPC", counters.ipc());
+    add("L1D misses", counters.l1d_misses);
+    add("LLC misses", counters.llc_misses);
+    add("branch misses", counters.branch_misses);
+    line.pop_back();
+
+    write_line(line, color::Magenta);
+}
+
+inline benchmark_function_result
+measure(const batch_function&     run_batch,
+        int                       repetition,
+        const benchmark_settings& settings)
+{
+    benchmark_function_result result;
+
+    result.iterations = calibrate(run_batch, settings);
+
+    const auto sample_count = static_cast<size_t>(std::max(1, repetition));
+    result.samples.reserve(sample_count);
+
+    std::optional<perf_counters>             counters;
+    std::array<double, perf_counters::count> totals {};
+
+    if(settings.hardware_counters)
+        counters.emplace();
+
+    allocation_scope allocations;
+    allocations.start();
+
+    for(size_t i = 0; i < sample_count; i++)
+    {
+        if(counters)
+            counters->start();
+
+        const double time = run_batch(result.iterations);
+
+        if(counters)
+            counters->stop(totals);
+
+        result.total_time += time;
+        result.samples.push_back(time / static_cast<double>(result.iterations));
+    }
+
+    const auto calls =
+        static_cast<double>(sample_count * result.iterations);
+    const auto allocated = allocations.stats();
+
+    result.allocations     = static_cast<double>(allocated.allocations) / calls;
+    result.allocated_bytes = static_cast<double>(allocated.bytes) / calls;
+
+    if(counters)
+        result.counters = counters->per_call(totals, calls);
+
+    const auto statistics = compute_statistics(result.samples);
+    result.min_time       = statistics.min;
+    result.max_time       = statistics.max;
+    result.mean_time      = statistics.mean;
+    result.median_time    = statistics.median;
+    result.p90_time       = statistics.p90;
+    result.p99_time       = statistics.p99;
+    result.stddev         = statistics.stddev;
+    result.mad            = statistics.mad;
+    result.outliers       = statistics.outliers;
+
+    log_benchmark_function_result(result);
+
+    if(settings.hardware_counters)
+        log_hardware_counters(result.counters);
+    return result;
+}
+}    // namespace detail
+
+/*!
+ * @brief Measures @p function
+ *
+ * The function first runs for the warmup time, which also tells how many
+ * calls make a sample last the sample time. Then @p repetition samples are
+ * measured with std::chrono::steady_clock, and summarized.
+ *
+ * @p function can be any callable taking no parameter. It isn't type erased,
+ * so calling it costs nothing more than a direct call inside the timed loop.
+ */
+template<class Function>
+benchmark_function_result
+run_benchmark_function(Function                  function,
+                       int                       repetition,
+                       const benchmark_settings& settings = {})
+{
+    return detail::measure(detail::make_batch_function(std::move(function)),
+                           repetition, settings);
+}
+
+namespace detail
+{
+inline string format_ratio(double ratio)
+{
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.2fx", ratio);
+    return buffer;
+}
+
+/*!
+ * @brief Ranks the candidates of @p result against the fastest one
+ */
+inline void compare_candidates(benchmark_result& result)
+{
+    const auto& results = result.results;
+
+    for(size_t i = 1; i < results.size(); i++)
+        if(results[i].median_time < results[result.fastest].median_time)
+            result.fastest = i;
+
+    for(size_t i = 0; i < results.size(); i++)
+    {
+        if(i == result.fastest)
+            continue;
+
+        result.comparisons.push_back(
+            {i, bootstrap_median_ratio(results[i].samples,
+                                       results[result.fastest].samples)});
+    }
+
+    std::stable_sort(result.comparisons.begin(), result.comparisons.end(),
+                     [](const benchmark_comparison& a,
+                        const benchmark_comparison& b)
+                     { return a.slowdown.ratio < b.slowdown.ratio; });
+}
+
+inline void log_comparisons(const benchmark& benchmark,
+                            const benchmark_result& result)
+{
+    const auto& fastest = benchmark.candidates[result.fastest].name;
+
+    for(const auto& comparison : result.comparisons)
+    {
+        const auto& other    = benchmark.candidates[comparison.candidate].name;
+        const auto& slowdown = comparison.slowdown;
+        const auto  interval = "95% CI : " + format_ratio(slowdown.lower) +
+                              " - " + format_ratio(slowdown.upper);
+
+        if(slowdown.significant())
+            write("    * " + fastest + " is " + format_ratio(slowdown.ratio) +
+                      " faster than " + other + " (" + interval + ")\n",
+                  color::Cyan);
+        else
+            write("    * No significant difference between " + fastest +
+                      " and " + other + " (" + format_ratio(slowdown.ratio) +
+                      ", " + interval + ")\n",
+                  color::Cyan);
+    }
+}
+}    // namespace detail
+
+/*!
+ * @brief Measures every candidate of @p benchmark and compares them
+ *
+ * A candidate is only said to be faster than another when the 95% confidence
+ * interval of the ratio between their medians doesn't contain 1
+ */
+inline benchmark_result run_benchmark(benchmark&                benchmark,
+                                      const benchmark_settings& settings = {})
+{
+    benchmark_result result;
+
+    for(const auto& candidate : benchmark.candidates)
+    {
+        detail::write("    * Benchmarking function " + candidate.name + "\n",
+                      detail::color::Green);
+        result.results.push_back(detail::measure(
+            candidate.run_batch, benchmark.repetition, settings));
+    }
+
+    detail::compare_candidates(result);
+    detail::log_comparisons(benchmark, result);
+    return result;
+}
+
+struct range_benchmark_result
+{
+    vector<size_t>                    sizes;
+    vector<benchmark_function_result> results;    // Same order as sizes
+
+    /*!
+     * @brief Complexity fitting the median times the best
+     */
+    detail::complexity_fit complexity;
+};
+
+/*!
+ * @brief Measures @p benchmark for every size of its range, and fits the
+ * median times to a complexity
+ */
+inline range_benchmark_result
+run_range_benchmark(const range_benchmark&    benchmark,
+                    const benchmark_settings& settings = {})
+{
+    range_benchmark_result result;
+    result.sizes = benchmark.range.sizes();
+
+    vector<double> sizes;
+    vector<double> medians;
+
+    for(const auto size : result.sizes)
+    {
+        detail::write("    * Size " + std::to_string(size) + "\n",
+                      detail::color::Green);
+
+        // The setup runs here, before anything is timed
+        const auto run_batch = benchmark.prepare(size);
+
+        result.results.push_back(
+            detail::measure(run_batch, benchmark.repetition, settings));
+        sizes.push_back(static_cast<double>(size));
+        medians.push_back(result.results.back().median_time);
+    }
+
+    result.complexity = detail::fit_complexity(sizes, medians);
+
+    char buffer[128];
+    std::snprintf(buffer, sizeof(buffer), "%s, %.4g ns per unit (RMS %.1f%%)",
+                  detail::to_string(result.complexity.big_o),
+                  result.complexity.coefficient,
+                  result.complexity.rms * 100.0);
+    detail::write("    * Complexity : " + string(buffer) + "\n",
+                  detail::color::Cyan);
+    return result;
+}
+
+/*!
+ * @brief Measures of a threaded benchmark for a given number of threads
+ */
+struct thread_scaling
+{
+    size_t threads {0};
+    size_t iterations {0};    // Calls per thread and per sample
+
+    /*!
+     * @brief Median over the samples of the calls made by every thread, per
+     * second, from the moment the threads are released to the end of the
+     * last one
+     */
+    double throughput {0.0};
+
+    /*!
+     * @brief Time of a call on a single thread, in nanoseconds, gathered
+     * over every thread of every sample
+     */
+    double median_latency {0.0};
+    double p99_latency {0.0};
+
+    /*!
+     * @brief Throughput compared to the single thread one multiplied by the
+     * number of threads. 1 is a perfect scaling
+     */
+    double efficiency {0.0};
+};
+
+struct threaded_benchmark_result
+{
+    vector<thread_scaling> scaling;    // From the fewest threads to the most
+};
+
+namespace detail
+{
+/*!
+ * @brief Runs one sample of @p benchmark on @p threads threads
+ *
+ * The threads are all started first, and wait for the same signal before
+ * running their batch, so thread creation isn't measured
+ *
+ * @param latencies     Receives the time of a call for every thread
+ * @return  Time between the signal and the end of the last thread, in
+ * nanoseconds
+ */
+inline double run_threads(const threaded_benchmark& benchmark,
+                          size_t                    threads,
+                          size_t                    iterations,
+                          vector<double>&           latencies)
+{
+    using clock = std::chrono::steady_clock;
+
+    std::atomic<size_t>       ready {0};
+    std::atomic<bool>         go {false};
+    vector<clock::time_point> ends(threads);
+    vector<double>            times(threads);
+    vector<std::thread>       workers;
+    workers.reserve(threads);
+
+    for(size_t t = 0; t < threads; t++)
+        workers.emplace_back(
+            [&, t]()
+            {
+                ready.fetch_add(1);
+                while(!go.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+
+                times[t] = benchmark.run_batch(t, iterations);
+                ends[t]  = clock::now();
+            });
+
+    while(ready.load() < threads)
+        std::this_thread::yield();
+
+    const auto start = clock::now();
+    go.store(true, std::memory_order_release);
+
+    for(auto& worker : workers)
+        worker.join();
+
+    for(const auto time : times)
+        latencies.push_back(time / static_cast<double>(iterations));
+
+    const auto end = *std::max_element(ends.begin(), ends.end());
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+inline void log_thread_scaling(const thread_scaling& scaling)
+{
+    char buffer[160];
+    std::snprintf(buffer, sizeof(buffer),
+                  "\t* %zu threads : %.4g calls/s, latency %s (p99 : %s), "
+                  "efficiency %.0f%%",
+                  scaling.threads, scaling.throughput,
+                  format_time(scaling.median_latency).c_str(),
+                  format_time(scaling.p99_latency).c_str(),
+                  scaling.efficiency * 100.0);
+    write_line(buffer, color::Magenta);
+}
+}    // namespace detail
+
+/*!
+ * @brief Measures @p benchmark on every thread count it asks for
+ *
+ * The number of calls a thread makes per sample is calibrated once on a
+ * single thread, so every thread count does the same work per thread
+ */
+inline threaded_benchmark_result
+run_threaded_benchmark(const threaded_benchmark& benchmark,
+                       const benchmark_settings& settings = {})
+{
+    threaded_benchmark_result result;
+
+    const auto iterations = detail::calibrate(
+        [&](size_t count) { return benchmark.run_batch(0, count); }, settings);
+    const auto samples = static_cast<size_t>(std::max(1, benchmark.repetition));
+
+    for(const auto threads : benchmark.thread_counts())
+    {
+        thread_scaling scaling;
+        scaling.threads    = threads;
+        scaling.iterations = iterations;
+
+        vector<double> throughputs;
+        vector<double> latencies;
+
+        for(size_t i = 0; i < samples; i++)
+        {
+            const double wall =
+                detail::run_threads(benchmark, threads, iterations, latencies);
+
+            if(wall > 0.0)
+                throughputs.push_back(
+                    static_cast<double>(threads * iterations) / wall * 1e9);
+        }
+
+        const auto statistics  = detail::compute_statistics(latencies);
+        scaling.throughput     = detail::median(throughputs);
+        scaling.median_latency = statistics.median;
+        scaling.p99_latency    = statistics.p99;
+
+        const double single = result.scaling.empty() ?
+                                  scaling.throughput :
+                                  result.scaling.front().throughput;
+        if(single > 0.0)
+            scaling.efficiency =
+                scaling.throughput / (single * static_cast<double>(threads));
+
+        detail::log_thread_scaling(scaling);
+        result.scaling.push_back(scaling);
+    }
+    return result;
+}
+
+namespace detail
+{
+/*!
+ * @brief Results of every kind of benchmark, each in registration order
+ */
+struct benchmark_results
+{
+    vector<benchmark_result>          plain;
+    vector<range_benchmark_result>    range;
+    vector<threaded_benchmark_result> threaded;
+};
+
+/*!
+ * @brief Runs every registered benchmark, then every range and threaded
+ * benchmark
+ */
+inline benchmark_results run_every_benchmark(const benchmark_settings& settings)
+{
+    benchmark_results results;
+
+    if(benchmarks.empty() && range_benchmarks.empty() &&
+       threaded_benchmarks.empty())
+        return results;
+
+    corgi::test::detail::write_title("Running benchmarks");
+    for(auto benchmark : benchmarks)
+    {
+        corgi::test::detail::write("  * Running ",
+                                   corgi::test::detail::color::Cyan);
+        corgi::test::detail::write(benchmark.name + "\n",
+                                   corgi::test::detail::color::Yellow);
+        results.plain.push_back(run_benchmark(benchmark, settings));
+
+        for(auto& reporter : detail::reporters)
+            reporter->benchmark_finished(benchmark, results.plain.back());
+    }
+
+    for(const auto& benchmark : range_benchmarks)
+    {
+        detail::write("  * Running ", detail::color::Cyan);
+        detail::write(benchmark.name + "\n", detail::color::Yellow);
+        results.range.push_back(run_range_benchmark(benchmark, settings));
+
+        for(auto& reporter : detail::reporters)
+            reporter->range_benchmark_finished(benchmark, results.range.back());
+    }
+
+    for(const auto& benchmark : threaded_benchmarks)
+    {
+        detail::write("  * Running ", detail::color::Cyan);
+        detail::write(benchmark.name + "\n", detail::color::Yellow);
+        results.threaded.push_back(run_threaded_benchmark(benchmark, settings));
+
+        for(auto& reporter : detail::reporters)
+            reporter->threaded_benchmark_finished(benchmark,
+                                                  results.threaded.back());
+    }
+    return results;
+}
+}    // namespace detail
+
+/*!
+ * @brief Runs every registered benchmark, then every range and threaded
+ * benchmark
+ * @return The result of every benchmark, in registration order. Range and
+ * threaded benchmarks only go to the log and the reporters
+ */
+inline vector<benchmark_result>
+run_benchmarks(const benchmark_settings& settings = {})
+{
+    return detail::run_every_benchmark(settings).plain;
+}
+
+namespace detail
+{
+/*!
+ * @brief Calls @p callback with the name and value of every statistic of
+ * @p result, so every reporter describes a benchmark the same way
+ */
+template<class Callback>
+void for_each_statistic(const benchmark_function_result& result,
+                        Callback&&                       callback)
+{
+    callback("iterations", static_cast<double>(result.iterations));
+    callback("samples", static_cast<double>(result.samples.size()));
+    callback("total_ns", result.total_time);
+    callback("min_ns", result.min_time);
+    callback("max_ns", result.max_time);
+    callback("mean_ns", result.mean_time);
+    callback("median_ns", result.median_time);
+    callback("p90_ns", result.p90_time);
+    callback("p99_ns", result.p99_time);
+    callback("stddev_ns", result.stddev);
+    callback("mad_ns", result.mad);
+    callback("outliers", static_cast<double>(result.outliers));
+
+    if(allocation_tracking)
+    {
+        callback("allocations", result.allocations);
+        callback("allocated_bytes", result.allocated_bytes);
+    }
+
+    const auto& counters = result.counters;
+    const std::pair<const char*, std::optional<double>> events[] = {
+        {"cycles", counters.cycles},
+        {"instructions", counters.instructions},
+        {"l1d_misses", counters.l1d_misses},
+        {"llc_misses", counters.llc_misses},
+        {"branch_misses", counters.branch_misses}};
+
+    for(const auto& [name, value] : events)
+        if(value)
+            callback(name, *value);
+}
+
+/*!
+ * @brief Same as the other overload, for a thread count of a threaded
+ * benchmark
+ */
+template<class Callback>
+void for_each_statistic(const thread_scaling& scaling, Callback&& callback)
+{
+    callback("threads", static_cast<double>(scaling.threads));
+    callback("iterations", static_cast<double>(scaling.iterations));
+    callback("throughput", scaling.throughput);
+    callback("median_latency_ns", scaling.median_latency);
+    callback("p99_latency_ns", scaling.p99_latency);
+    callback("efficiency", scaling.efficiency);
+}
+
+inline void append_number(string& text, double value)
+{
+    if(!std::isfinite(value))
+    {
+        text += "null";
+        return;
+    }
+
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    text += buffer;
+}
+
+inline void append_xml_string(string& xml, std::string_view text)
+{
+    for(const char c : text)
+    {
+        if(c == '&')
+            xml += "&amp;";
+        else if(c == '<')
+            xml += "&lt;";
+        else if(c == '>')
+            xml += "&gt;";
+        else if(c == '"')
+            xml += "&quot;";
+        else if(c == '\'')
+            xml += "&apos;";
+        else
+            xml += c;
+    }
+}
+
+/*!
+ * @brief Reporter writing into a file it may own
+ */
+class file_reporter : public reporter
+{
+public:
+    /*!
+     * @brief Writes into @p file, which stays open once the reporter is gone
+     */
+    explicit file_reporter(std::FILE* file)
+        : _file(file)
+    {
+    }
+
+    /*!
+     * @brief Creates or truncates the file at @p path
+     *
+     * Throws std::runtime_error if the file can't be opened
+     */
+    explicit file_reporter(const string& path)
+        : _file(std::fopen(path.c_str(), "wb"))
+        , _owned(true)
+    {
+        if(_file == nullptr)
+            throw std::runtime_error("Can't open the report file : " + path);
+    }
+
+    file_reporter(const file_reporter&)            = delete;
+    file_reporter& operator=(const file_reporter&) = delete;
+
+    ~file_reporter() override
+    {
+        if(_owned)
+            std::fclose(_file);
+    }
+
+protected:
+    /*!
+     * @brief Writes @p text and flushes it, so readers see every event as
+     * soon as it happens
+     */
+    void emit(const string& text)
+    {
+        std::fwrite(text.data(), 1, text.size(), _file);
+        std::fflush(_file);
+    }
+
+private:
+    std::FILE* _file;
+    bool       _owned {false};
+};
+}    // namespace detail
+
+/*!
+ * @brief Writes every event as a JSON object on its own line
+ *
+ * Events are "run_start", "test", "benchmark", "range_benchmark",
+ * "threaded_benchmark" and "run_end", told apart by their "event" member.
+ * Times are in microseconds for tests and in nanoseconds for benchmarks.
+ */
+class json_lines_reporter : public detail::file_reporter
+{
+public:
+    using file_reporter::file_reporter;
+
+    void run_started(size_t test_count) override
+    {
+        emit("{\"event\":\"run_start\",\"tests\":" +
+             std::to_string(test_count) + "}\n");
+    }
+
+    void test_finished(const test_report& report) override
+    {
+        string line = "{\"event\":\"test\",\"group\":";
+        detail::append_json_string(line, report.group);
+        line += ",\"name\":";
+        detail::append_json_string(line, report.name);
+
+        if(report.skipped)
+        {
+            emit(line + ",\"skipped\":true}\n");
+            return;
+        }
+
+        line += ",\"passed\":";
+        line += report.errors == 0 ? "true" : "false";
+        line += ",\"errors\":" + std::to_string(report.errors) +
+                ",\"time_us\":" + std::to_string(report.time);
+
+        if(detail::allocation_tracking)
+            line += ",\"allocations\":" +
+                    std::to_string(report.allocations.allocations) +
+                    ",\"allocated_bytes\":" +
+                    std::to_string(report.allocations.bytes) +
+                    ",\"peak_bytes\":" +
+                    std::to_string(report.allocations.peak_bytes);
+
+        emit(line + "}\n");
+    }
+
+    void benchmark_finished(const benchmark&        benchmark,
+                            const benchmark_result& result) override
+    {
+        string line = "{\"event\":\"benchmark\",\"name\":";
+        detail::append_json_string(line, benchmark.name);
+        line += ",\"candidates\":[";
+
+        for(size_t i = 0; i < result.results.size(); i++)
+        {
+            const auto& measures = result.results[i];
+
+            line += i == 0 ? "{\"name\":" : ",{\"name\":";
+            detail::append_json_string(line, benchmark.candidates[i].name);
+            append_measures(line, measures);
+            line += '}';
+        }
+
+        line += "],\"fastest\":";
+        if(result.results.empty())
+            line += "null";
+        else
+            detail::append_json_string(
+                line, benchmark.candidates[result.fastest].name);
+
+        line += ",\"comparisons\":[";
+        for(size_t i = 0; i < result.comparisons.size(); i++)
+        {
+            const auto& comparison = result.comparisons[i];
+            const auto& slowdown   = comparison.slowdown;
+
+            line += i == 0 ? "{\"candidate\":" : ",{\"candidate\":";
+            detail::append_json_string(
+                line, benchmark.candidates[comparison.candidate].name);
+            line += ",\"slowdown\":";
+            detail::append_number(line, slowdown.ratio);
+            line += ",\"lower\":";
+            detail::append_number(line, slowdown.lower);
+            line += ",\"upper\":";
+            detail::append_number(line, slowdown.upper);
+            line += ",\"significant\":";
+            line += slowdown.significant() ? "true}" : "false}";
+        }
+        emit(line + "]}\n");
+    }
+
+    void range_benchmark_finished(const range_benchmark&        benchmark,
+                                  const range_benchmark_result& result) override
+    {
+        string line = "{\"event\":\"range_benchmark\",\"name\":";
+        detail::append_json_string(line, benchmark.name);
+        line += ",\"complexity\":";
+        detail::append_json_string(line,
+                                   detail::to_string(result.complexity.big_o));
+        line += ",\"coefficient\":";
+        detail::append_number(line, result.complexity.coefficient);
+        line += ",\"rms\":";
+        detail::append_number(line, result.complexity.rms);
+        line += ",\"sizes\":[";
+
+        for(size_t i = 0; i < result.results.size(); i++)
+        {
+            line += i == 0 ? "{\"size\":" : ",{\"size\":";
+            line += std::to_string(result.sizes[i]);
+            append_measures(line, result.results[i]);
+            line += '}';
+        }
+        emit(line + "]}\n");
+    }
+
+    void threaded_benchmark_finished(
+        const threaded_benchmark&        benchmark,
+        const threaded_benchmark_result& result) override
+    {
+        string line = "{\"event\":\"threaded_benchmark\",\"name\":";
+        detail::append_json_string(line, benchmark.name);
+        line += ",\"scaling\":[";
+
+        for(size_t i = 0; i < result.scaling.size(); i++)
+        {
+            line += i == 0 ? "{" : ",{";
+            detail::for_each_statistic(result.scaling[i],
+                                       [&](const char* name, double value)
+                                       {
+                                           if(line.back() != '{')
+                                               line += ',';
+                                           line += '"';
+                                           line += name;
+                                           line += "\":";
+                                           detail::append_number(line, value);
+                                       });
+            line += '}';
+        }
+        emit(line + "]}\n");
+    }
+
+    void run_finished(int errors) override
+    {
+        emit("{\"event\":\"run_end\",\"errors\":" + std::to_string(errors) +
+             "}\n");
+    }
+
+private:
+    /*!
+     * @brief Appends the statistics and samples of @p measures as members of
+     * the object being written
+     */
+    static void append_measures(string&                          line,
+                                const benchmark_function_result& measures)
+    {
+        detail::for_each_statistic(measures,
+                                   [&](const char* name, double value)
+                                   {
+                                       line += ",\"";
+                                       line += name;
+                                       line += "\":";
+                                       detail::append_number(line, value);
+                                   });
+
+        line += ",\"samples_ns\":[";
+        for(size_t i = 0; i < measures.samples.size(); i++)
+        {
+            if(i > 0)
+                line += ',';
+            detail::append_number(line, measures.samples[i]);
+        }
+        line += ']';
+    }
+};
+
+/*!
+ * @brief Writes a JUnit XML document, one test suite per group
+ *
+ * A suite is opened with the first test of its group and closed once
+ * another group, a benchmark or the end of the run comes, so only the name
+ * of the open group is kept in memory. The failure count of a suite isn't
+ * known when it is opened, and is left for the consumers to count. Tests
+ * skipped by fail fast are written with a skipped element. Every benchmark is
+ * a suite whose test cases are its candidates, with their statistics as
+ * properties.
+ */
+class junit_reporter : public detail::file_reporter
+{
+public:
+    using file_reporter::file_reporter;
+
+    void run_started(size_t /*test_count*/) override
+    {
+        emit("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n");
+    }
+
+    void test_finished(const test_report& report) override
+    {
+        string xml;
+
+        if(_suite_open && _suite != report.group)
+            close_suite(xml);
+
+        if(!_suite_open)
+        {
+            _suite      = report.group;
+            _suite_open = true;
+
+            xml += "  <testsuite name=\"";
+            detail::append_xml_string(xml, report.group);
+            xml += "\" tests=\"" + std::to_string(report.group_size) + "\">\n";
+        }
+
+        xml += "    <testcase classname=\"";
+        detail::append_xml_string(xml, report.group);
+        xml += "\" name=\"";
+        detail::append_xml_string(xml, report.name);
+        xml += "\" time=\"" + seconds(static_cast<double>(report.time) * 1e3) +
+               "\"";
+
+        if(report.skipped)
+            xml += ">\n      <skipped/>\n    </testcase>\n";
+        else if(report.errors == 0)
+            xml += "/>\n";
+        else
+            xml += ">\n      <failure message=\"" +
+                   std::to_string(report.errors) +
+                   " failed checks\"/>\n    </testcase>\n";
+
+        emit(xml);
+    }
+
+    void benchmark_finished(const benchmark&        benchmark,
+                            const benchmark_result& result) override
+    {
+        string xml;
+        close_suite(xml);
+
+        xml += "  <testsuite name=\"";
+        detail::append_xml_string(xml, benchmark.name);
+        xml += "\" tests=\"" + std::to_string(result.results.size()) + "\">\n";
+
+        for(size_t i = 0; i < result.results.size(); i++)
+            append_measures(xml, benchmark.name, benchmark.candidates[i].name,
+                            result.results[i]);
+
+        emit(xml + "  </testsuite>\n");
+    }
+
+    /*!
+     * @brief Writes a suite whose test cases are the sizes, with the fitted
+     * complexity as properties of the suite
+     */
+    void range_benchmark_finished(const range_benchmark&        benchmark,
+                                  const range_benchmark_result& result) override
+    {
+        string xml;
+        close_suite(xml);
+
+        xml += "  <testsuite name=\"";
+        detail::append_xml_string(xml, benchmark.name);
+        xml += "\" tests=\"" + std::to_string(result.results.size()) +
+               "\">\n    <properties>\n"
+               "      <property name=\"complexity\" value=\"";
+        xml += detail::to_string(result.complexity.big_o);
+        xml += "\"/>\n      <property name=\"coefficient\" value=\"";
+        detail::append_number(xml, result.complexity.coefficient);
+        xml += "\"/>\n      <property name=\"rms\" value=\"";
+        detail::append_number(xml, result.complexity.rms);
+        xml += "\"/>\n    </properties>\n";
+
+        for(size_t i = 0; i < result.results.size(); i++)
+            append_measures(xml, benchmark.name,
+                            std::to_string(result.sizes[i]), result.results[i]);
+
+        emit(xml + "  </testsuite>\n");
+    }
+
+    /*!
+     * @brief Writes a suite whose test cases are the thread counts
+     */
+    void threaded_benchmark_finished(
+        const threaded_benchmark&        benchmark,
+        const threaded_benchmark_result& result) override
+    {
+        string xml;
+        close_suite(xml);
+
+        xml += "  <testsuite name=\"";
+        detail::append_xml_string(xml, benchmark.name);
+        xml += "\" tests=\"" + std::to_string(result.scaling.size()) + "\">\n";
+
+        for(const auto& scaling : result.scaling)
+        {
+            xml += "    <testcase classname=\"";
+            detail::append_xml_string(xml, benchmark.name);
+            xml += "\" name=\"" + std::to_string(scaling.threads) +
+                   " threads\">\n      <properties>\n";
+
+            detail::for_each_statistic(scaling,
+                                       [&](const char* statistic, double value)
+                                       {
+                                           xml += "        <property name=\"";
+                                           xml += statistic;
+                                           xml += "\" value=\"";
+                                           detail::append_number(xml, value);
+                                           xml += "\"/>\n";
+                                       });
+            xml += "      </properties>\n    </testcase>\n";
+        }
+        emit(xml + "  </testsuite>\n");
+    }
+
+    void run_finished(int /*errors*/) override
+    {
+        string xml;
+        close_suite(xml);
+        emit(xml + "</testsuites>\n");
+    }
+
+private:
+    /*!
+     * @brief Appends the end of the suite of the last group, if it is open
+     */
+    void close_suite(string& xml)
+    {
+        if(!_suite_open)
+            return;
+
+        xml += "  </testsuite>\n";
+        _suite_open = false;
+    }
+
+    /*!
+     * @brief Appends a test case holding the statistics of @p measures
+     */
+    static void append_measures(string&                          xml,
+                                const string&                    class_name,
+                                const string&                    name,
+                                const benchmark_function_result& measures)
     {
-        T* t           = new T();
-        t->_class_name = class_name;
-        t->_test_name  = test_name;
+        xml += "    <testcase classname=\"";
+        detail::append_xml_string(xml, class_name);
+        xml += "\" name=\"";
+        detail::append_xml_string(xml, name);
+        xml += "\" time=\"" + seconds(measures.total_time) +
+               "\">\n      <properties>\n";
 
-        fixtures_map[class_name].emplace_back(t);
-        return 0;    // We only return a value because of the affectation trick
-                     // in the macro
+        detail::for_each_statistic(measures,
+                                   [&](const char* statistic, double value)
+                                   {
+                                       xml += "        <property name=\"";
+                                       xml += statistic;
+                                       xml += "\" value=\"";
+                                       detail::append_number(xml, value);
+                                       xml += "\"/>\n";
+                                   });
+        xml += "      </properties>\n    </testcase>\n";
     }
-    catch(const std::exception& e)
+
+    static string seconds(double nanoseconds)
     {
-        std::cout << " ERROR " << e.what() << std::endl;
-        return 0;
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.6f", nanoseconds / 1e9);
+        return buffer;
     }
+
+    string _suite;    // Group of the open suite
+    bool   _suite_open {false};
+};
+
+/*!
+ * @brief Adds a reporter to the next call to @ref run_all, which releases it
+ * once the run is over
+ */
+inline void add_reporter(unique_ptr<reporter> reporter)
+{
+    detail::reporters.push_back(std::move(reporter));
 }
 
+namespace detail
+{
 /*!
- * @brief  Logs every failed function inside the console as a summary report
+ * @brief Median time of a call, in nanoseconds, of every candidate of a
+ * previous run, found by @ref baseline_key
  */
-inline void log_failed_functions()
+using baseline = map<string, double>;
+
+/*!
+ * @brief Appends @p name with its backslashes, tabs, new lines, carriage
+ * returns and '#' escaped, so it can't break a line of a baseline nor make
+ * it a comment
+ */
+inline void append_baseline_name(string& text, const string& name)
 {
-    for(const auto& [group_name, group] : detail::failed_functions)
+    for(const char c : name)
     {
-        for(const auto& [function_name, function] : group)
-        {
-            write_line("      * Function " + group_name + "::" + function_name +
-                           " failed",
-                       color::Red);
-
-            for(const auto& test_function : detail::failed_fixtures)
-                write_line("      * " + test_function->_class_name +
-                               "::" + test_function->_test_name + " failed",
-                           color::Red);
-        }
+        if(c == '\\')
+            text += "\\\\";
+        else if(c == '\t')
+            text += "\\t";
+        else if(c == '\n')
+            text += "\\n";
+        else if(c == '\r')
+            text += "\\r";
+        else if(c == '#')
+            text += "\\#";
+        else
+            text += c;
     }
 }
 
 /*!
- * @brief  Logs that we successfully pass every test
+ * @brief The benchmark and candidate names, escaped and separated by a tab,
+ * like they are written inside a baseline
  */
-inline void log_success()
+inline string baseline_key(const string& benchmark, const string& candidate)
 {
-    write_line("    * Every test passed", color::Green);
+    string key;
+    append_baseline_name(key, benchmark);
+    key += '\t';
+    append_baseline_name(key, candidate);
+    return key;
 }
 
 /*!
- * @brief  Logs that at least 1 test failed
+ * @brief Median time of a call measured by a benchmark, as a baseline saves
+ * and compares it
  */
-inline void log_failure()
+struct baseline_entry
 {
-    write_line("    Error : Some test failed to pass", color::Red);
-    write_line("    Logging the Functions that failed", color::Cyan);
-    log_failed_functions();
-}
+    string                benchmark;
+    string                candidate;    // Or the size, or the thread count
+    double                median {0.0};
+    std::optional<double> tolerance;    // The run's one when empty
+};
 
 /*!
- *   @brief  Write an header in the console
- *   @detail Just write something in that way inside the console
- *   +---------+
- *   |   Text  |
- *   +---------+
+ * @brief Appends the median of every candidate of @p results
  */
-inline void write_title(const string& text)
+inline void append_baseline_entries(vector<baseline_entry>&         entries,
+                                    const vector<benchmark>&        benchmarks,
+                                    const vector<benchmark_result>& results)
 {
-    const int max_column = 78;
-
-    write("+", color::Green);
-    write(string(max_column - 2, '-'));
-    write("+\n");
-
-    write_line("|    " + text +
-               string(max_column - 1 - (5 + text.size()), ' ') + "|");
-
-    write("+");
-    write(string(max_column - 2, '-'));
-    write("+\n");
+    for(size_t i = 0; i < results.size(); i++)
+        for(size_t j = 0; j < results[i].results.size(); j++)
+            entries.push_back({benchmarks[i].name,
+                               benchmarks[i].candidates[j].name,
+                               results[i].results[j].median_time,
+                               benchmarks[i].tolerance});
 }
 
 /*!
- *   @brief  Logs that we're running tests that belongs to the @ref group_name
- * group
- *   @param  group_name  Name of the tested group
- *   @param  group_size  How many test are inside the group
+ * @brief Appends the median of every size of @p results, named "size "
+ * followed by the size
  */
-inline void log_start_group(const string& group_name, size_t group_size)
+inline void
+append_baseline_entries(vector<baseline_entry>&               entries,
+                        const vector<range_benchmark>&        benchmarks,
+                        const vector<range_benchmark_result>& results)
 {
-    write_title("Running " + std::to_string(group_size) + " tests grouped in " +
-                group_name);
+    for(size_t i = 0; i < results.size(); i++)
+        for(size_t j = 0; j < results[i].results.size(); j++)
+            entries.push_back({benchmarks[i].name,
+                               "size " + std::to_string(results[i].sizes[j]),
+                               results[i].results[j].median_time,
+                               {}});
 }
 
 /*!
- * @brief Log that we're starting a test
- * @param test_name    Name of the test we're running
- * @param group_name   Name of the group the test belongs to
- * @param count        Counter used to know on which test from group we're (like
- * the first one, the second one ? etc
+ * @brief Appends the median latency of every thread count of @p results,
+ * named "threads " followed by the count
  */
-inline void log_start_test(const string& test_name,
-                           const string& group_name,
-                           size_t        group_size,
-                           size_t        count)
+inline void
+append_baseline_entries(vector<baseline_entry>&                  entries,
+                        const vector<threaded_benchmark>&        benchmarks,
+                        const vector<threaded_benchmark_result>& results)
 {
-    write("  * Running ", color::Cyan);
-    write(group_name + "." + test_name, color::Yellow);
-    write(" (" + std::to_string(count) + "/" + std::to_string(group_size) +
-              ")\n",
-          color::Cyan);
+    for(size_t i = 0; i < results.size(); i++)
+        for(const auto& scaling : results[i].scaling)
+            entries.push_back({benchmarks[i].name,
+                               "threads " + std::to_string(scaling.threads),
+                               scaling.median_latency,
+                               {}});
 }
 
 /*!
- * @brief  Log that a test was successful
+ * @brief Writes the median of every entry
+ *
+ * One line per entry, holding the benchmark name, the candidate name and the
+ * median, separated by tabs. Names are escaped by @ref baseline_key.
  */
-inline void log_test_success(long long time)
+inline void write_baseline(std::FILE*                    file,
+                           const vector<baseline_entry>& entries)
 {
-    write_line("       Passed in " +
-                   std::to_string(static_cast<double>(time) / 1000.0) + " ms",
-               color::Green);
-}
-}    // namespace detail
+    string text = "# corgi-test benchmark baseline, median in nanoseconds\n";
 
-// register the time it takes for a function to run
-inline auto function_time(std::function<void()> fun) -> long long
-{
-    const auto start = std::chrono::high_resolution_clock::now();
-    fun();
-    const auto end = std::chrono::high_resolution_clock::now();
-    return std::chrono::duration_cast<std::chrono::microseconds>(end - start)
-        .count();
+    for(const auto& entry : entries)
+    {
+        text += baseline_key(entry.benchmark, entry.candidate) + '\t';
+        append_number(text, entry.median);
+        text += '\n';
+    }
+
+    std::fwrite(text.data(), 1, text.size(), file);
+    std::fflush(file);
 }
 
-inline void run_fixtures()
+/*!
+ * @brief Reads what @ref write_baseline wrote
+ *
+ * Throws std::runtime_error if a line isn't made of two names and a number
+ * of nanoseconds
+ */
+inline baseline read_baseline(std::FILE* file)
 {
-    for(auto& fixture : detail::fixtures_map)    // Loop through every fixture
+    baseline result;
+    string   line;
+    int      c {0};
+
+    do
     {
-        auto total_test = detail::fixtures_map[fixture.first].size();
-        int  test_index {1};
+        c = std::fgetc(file);
 
-        detail::log_start_group(fixture.first, total_test);
+        if(c != EOF && c != '\n')
+        {
+            line += static_cast<char>(c);
+            continue;
+        }
 
-        for(auto& test : fixture.second)    // loop through every fixture's test
+        if(!line.empty() && line[0] != '#')
         {
-            detail::log_start_test(test->_test_name, test->_class_name,
-                                   total_test, test_index++);
+            const auto separator = line.rfind('\t');
+            char*      end {nullptr};
+            double     median {0.0};
 
-            // The assert function will increment the error count if something
-            // went wrong. So we just registered how many error we had before
-            // running the fixture, and compare afterward to know if the
-            // fixture was a success or not
-            int error_value = detail::error;
+            if(separator != string::npos)
+                median = std::strtod(line.c_str() + separator + 1, &end);
 
-            test->set_up();
-            auto time = function_time([&]() { test->run(); });
-            test->tear_down();
+            if(std::count(line.begin(), line.end(), '\t') != 2 ||
+               end == line.c_str() + separator + 1 || *end != '\0' ||
+               !std::isfinite(median) || median < 0.0)
+                throw std::runtime_error("Invalid baseline line : " + line);
 
-            if(error_value == detail::error)
-                detail::log_test_success(time);
-            else
-            {
-                // detail::get_failed_fixtures().push_back(test_object);
-            }
-            std::cout << std::flush;
+            result[line.substr(0, separator)] = median;
         }
-    }
+        line.clear();
+    } while(c != EOF);
+
+    return result;
 }
 
-inline void run_functions()
+/*!
+ * @brief How the median of a candidate moved since the baseline
+ */
+struct baseline_comparison
 {
-    for(const auto& [group_name, group] : detail::map_test_functions)
-    {
-        auto total_test = group.size();
-        detail::log_start_group(group_name, total_test);
-        int test_index {1};
+    string benchmark;
+    string candidate;
+    double baseline_time {0.0};
+    double time {0.0};
+    double tolerance {0.0};    // Slowdown allowed, 0.1 for 10%
 
-        for(const auto& [test_name, test] : group)
-        {
-            detail::log_start_test(test_name, group_name, total_test,
-                                   test_index++);
+    bool regressed() const { return time > baseline_time * (1.0 + tolerance); }
+};
 
-            int  error_value = detail::error;
-            auto time        = function_time(test);
+/*!
+ * @brief Compares every entry found inside @p reference
+ *
+ * An entry without its own tolerance uses @p default_tolerance. Entries whose
+ * baseline median is 0 are skipped, no slowdown can be measured against it.
+ */
+inline vector<baseline_comparison>
+compare_to_baseline(const vector<baseline_entry>& entries,
+                    const baseline&               reference,
+                    double                        default_tolerance)
+{
+    vector<baseline_comparison> comparisons;
 
-            if(error_value == detail::error)
-                detail::log_test_success(time);
-            else
-                detail::failed_functions[group_name].emplace(test_name, test);
-        }
+    for(const auto& entry : entries)
+    {
+        const auto found =
+            reference.find(baseline_key(entry.benchmark, entry.candidate));
+
+        if(found == reference.end() || found->second <= 0.0)
+            continue;
+
+        comparisons.push_back({entry.benchmark, entry.candidate, found->second,
+                               entry.median,
+                               entry.tolerance.value_or(default_tolerance)});
     }
+    return comparisons;
 }
 
-struct benchmark
+/*!
+ * @brief Logs @p comparisons, and fails the run for every regression
+ */
+inline void log_baseline_comparisons(
+    const vector<baseline_comparison>& comparisons)
 {
-    benchmark(std::function<void()> first_function,
-              std::string           first_function_name,
-              std::function<void()> second_function,
-              std::string           second_function_name,
-              int                   repetition,
-              std::string           name)
-        : first_function(first_function)
-        , first_function_name(first_function_name)
-        , second_function(second_function)
-        , second_function_name(second_function_name)
-        , repetition(repetition)
-        , name(name)
+    write_title("Comparing benchmarks to the baseline");
 
+    for(const auto& comparison : comparisons)
     {
-    }
-
-    std::function<void()> first_function;
-    std::string           first_function_name;
-    std::function<void()> second_function;
-    std::string           second_function_name;
-    int                   repetition;
-    std::string           name;
-};
+        const auto name = comparison.benchmark + "/" + comparison.candidate;
+        const auto text =
+            "    * " + name + " : " + format_time(comparison.time) + " (" +
+            format_ratio(comparison.time / comparison.baseline_time) +
+            " the baseline " + format_time(comparison.baseline_time) +
+            ", tolerance " +
+            std::to_string(static_cast<int>(comparison.tolerance * 100.0)) +
+            "%)";
 
-static inline std::vector<benchmark> benchmarks;
+        if(!comparison.regressed())
+        {
+            write_line(text, color::Green);
+            continue;
+        }
 
-inline void add_benchmark(std::string name,
-                          int         repetition,
-                          void (*first_function)(),
-                          const std::string& first_function_name,
-                          void (*second_function)(),
-                          const std::string& second_function_name)
-{
-    benchmarks.push_back(benchmark(std::function<void()>(first_function),
-                                   first_function_name,
-                                   std::function<void()>(second_function),
-                                   second_function_name, repetition, name));
+        write_line(text + " regressed", color::Red);
+        failed_tests.push_back("benchmark::" + name);
+        error += 1;
+    }
 }
 
-inline void add_test(const std::string&    group_name,
-                     const std::string&    test_name,
-                     std::function<void()> lambda)
+/*!
+ * @brief Compares @p results to the baseline file of @p run_options, then
+ * saves them as the new baseline, when asked to
+ *
+ * Every kind of benchmark is part of the baseline. A missing baseline file
+ * only gives a warning, so the first run of a new baseline doesn't fail.
+ * Throws std::runtime_error if a file can't be written or is malformed.
+ */
+inline void handle_baseline(const options&           run_options,
+                            const benchmark_results& results)
 {
-    corgi::test::detail::map_test_functions[group_name].emplace(test_name,
-                                                                lambda);
-}
+    vector<baseline_entry> entries;
+    append_baseline_entries(entries, benchmarks, results.plain);
+    append_baseline_entries(entries, range_benchmarks, results.range);
+    append_baseline_entries(entries, threaded_benchmarks, results.threaded);
 
-struct benchmark_function_result
-{
-    long long total_time = 0;
-    long long max_time   = std::numeric_limits<long long>::min();
-    long long min_time   = std::numeric_limits<long long>::max();
-};
+    if(!run_options.compare_baseline.empty())
+    {
+        const auto& path = run_options.compare_baseline;
 
-struct benchmark_result
-{
-    benchmark_function_result first_function_results;
-    benchmark_function_result second_function_results;
-};
+        if(auto* file = std::fopen(path.c_str(), "rb"))
+        {
+            std::unique_ptr<std::FILE, int (*)(std::FILE*)> closer(
+                file, &std::fclose);
 
-inline benchmark_function_result
-run_benchmark_function(std::function<void()> function, int repetition)
-{
-    benchmark_function_result result;
+            log_baseline_comparisons(
+                compare_to_baseline(entries, read_baseline(file),
+                                    run_options.regression_tolerance));
+        }
+        else
+            write_line("    * No baseline at " + path + ", nothing compared",
+                       color::Yellow);
+    }
 
-    for(int i = 0; i < repetition; i++)
+    if(!run_options.save_baseline.empty())
     {
-        auto time = function_time(function);
-        result.total_time += time;
+        const auto& path = run_options.save_baseline;
+        auto*       file = std::fopen(path.c_str(), "wb");
 
-        result.max_time = std::max(result.max_time, time);
-        result.min_time = std::min(result.min_time, time);
-    }
-
-    corgi::test::detail::write_line(
-        "\t* Total Time : " +
-            std::to_string(static_cast<double>(result.total_time) / 1000.0) +
-            " ms",
-        corgi::test::detail::color::Magenta);
-    corgi::test::detail::write_line(
-        "\t* Max Time : " +
-            std::to_string(static_cast<double>(result.max_time) / 1000.0) +
-            " ms",
-        corgi::test::detail::color::Magenta);
-    corgi::test::detail::write_line(
-        "\t* Min Time : " +
-            std::to_string(static_cast<double>(result.min_time) / 1000.0) +
-            " ms",
-        corgi::test::detail::color::Magenta);
-    corgi::test::detail::write_line(
-        "\t* Mean Time : " +
-            std::to_string(static_cast<double>(result.total_time / repetition) /
-                           1000.0) +
-            " ms",
-        corgi::test::detail::color::Magenta);
-    return result;
-}
-inline void run_benchmark(benchmark& benchmark)
-{
-    benchmark_result result;
-    corgi::test::detail::write("    * Benchmarking function " +
-                                   benchmark.first_function_name + "\n",
-                               corgi::test::detail::color::Green);
-    result.first_function_results =
-        run_benchmark_function(benchmark.first_function, benchmark.repetition);
-    corgi::test::detail::write("    * Benchmarking function " +
-                                   benchmark.second_function_name + "\n",
-                               corgi::test::detail::color::Green);
-    result.second_function_results =
-        run_benchmark_function(benchmark.second_function, benchmark.repetition);
-
-    if(result.first_function_results.total_time >=
-       result.second_function_results.total_time)
-        corgi::test::detail::write("    *" + benchmark.first_function_name +
-                                       " was faster\n",
-                                   corgi::test::detail::color::Cyan);
-    else
-        corgi::test::detail::write("    *" + benchmark.second_function_name +
-                                       " was faster\n",
-                                   corgi::test::detail::color::Cyan);
+        if(file == nullptr)
+            throw std::runtime_error("Can't write the baseline : " + path);
+
+        write_baseline(file, entries);
+        std::fclose(file);
+    }
 }
 
-inline void run_benchmarks()
+/*!
+ * @brief Reads the history of the previous runs, if the run keeps one
+ *
+ * A missing file is a first run, and leaves the history empty
+ */
+inline void load_history(const options& run_options)
 {
-    if(benchmarks.empty())
+    history.reset();
+
+    if(run_options.history.empty())
+    {
+        if(run_options.failed_first)
+            throw std::runtime_error("--failed-first needs a --history file");
         return;
+    }
 
-    corgi::test::detail::write_title("Running benchmarks");
-    for(auto benchmark : benchmarks)
+    history.emplace();
+
+    if(auto* file = std::fopen(run_options.history.c_str(), "rb"))
     {
-        corgi::test::detail::write("  * Running ",
-                                   corgi::test::detail::color::Cyan);
-        corgi::test::detail::write(benchmark.name + "\n",
-                                   corgi::test::detail::color::Yellow);
-        run_benchmark(benchmark);
+        try
+        {
+            history->read(file);
+        }
+        catch(...)
+        {
+            std::fclose(file);
+            throw;
+        }
+        std::fclose(file);
     }
 }
 
+inline void save_history(const options& run_options)
+{
+    if(!history)
+        return;
+
+    const auto& path = run_options.history;
+    auto*       file = std::fopen(path.c_str(), "wb");
+
+    if(file == nullptr)
+        throw std::runtime_error("Can't write the history : " + path);
+
+    history->write(file);
+    std::fclose(file);
+}
+}    // namespace detail
+
 /*!
  * @brief      Run all the tests defined by the user
  * @details    Must be called from main. Will fire all the test the user defined
  * with the TEST macro. Warning, this function returns a value that must be
  * returned inside the main function!
  */
-inline int run_all()
+inline int run_all(const options& run_options)
 {
+    if(run_options.sync_output)
+        set_output_sink(std::make_unique<stream_sink>());
+    else
+        set_output_sink(std::make_unique<async_sink>());
+
+#ifdef CORGI_TEST_HAS_FORK
+    detail::crash_handlers handlers;
+#endif
+
     try
     {
-        run_fixtures();
-        run_functions();
-        run_benchmarks();
+        auto tests = detail::select_tests(detail::registry, run_options);
+
+        detail::load_history(run_options);
+        detail::shard_tests(tests, run_options.shard_index,
+                            run_options.shard_count,
+                            detail::history ? &*detail::history : nullptr);
+        if(run_options.failed_first)
+            detail::run_failed_first(tests, *detail::history);
+
+        if(run_options.list)
+        {
+            detail::sink().write(detail::list_tests(tests));
+            detail::sink().flush();
+            return 0;
+        }
+
+        detail::fail_fast         = run_options.fail_fast;
+        detail::stopping          = false;
+        detail::skipped_tests     = 0;
+        detail::reported_failures = run_options.reported_failures;
+        detail::property_cases    = run_options.property_cases;
+        detail::property_jobs     = run_options.property_jobs;
+        detail::property_seed     = run_options.seed;
+
+        if(!run_options.json_report.empty())
+            add_reporter(
+                std::make_unique<json_lines_reporter>(run_options.json_report));
+        if(!run_options.junit_report.empty())
+            add_reporter(
+                std::make_unique<junit_reporter>(run_options.junit_report));
+
+        for(auto& reporter : detail::reporters)
+            reporter->run_started(tests.size());
+
+        detail::run_tests(tests, run_options);
+        detail::save_history(run_options);
+
+        if(!detail::stopping)
+            detail::handle_baseline(
+                run_options, detail::run_every_benchmark(run_options.benchmark));
         corgi::test::detail::write_title("Results");
         (detail::error == 0) ? corgi::test::detail::log_success() :
                                corgi::test::detail::log_failure();
+
+        for(auto& reporter : detail::reporters)
+            reporter->run_finished(detail::error);
     }
     catch(const std::exception& e)
     {
+        detail::sink().flush();
         std::cerr << e.what() << '\n';
+        detail::error += 1;    // The run didn't go through, it can't pass
     }
+    detail::reporters.clear();
+    detail::sink().flush();
     return detail::error;    // Must return 0 to pass
 }
 
+inline int run_all()
+{
+    return run_all(options {});
+}
+
+/*!
+ * @brief Same as @ref run_all, with options read from the command line
+ *
+ * Usually called with the parameters of the main function. See
+ * @ref parse_options for the supported arguments
+ */
+inline int run_all(int argc, char** argv)
+{
+    try
+    {
+        return run_all(parse_options(argc, argv));
+    }
+    catch(const std::invalid_argument& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+}
+
 /*!
  *   @brief  Define a new Fixture
  *
@@ -718,7 +5471,14 @@ inline int run_all()
  *   @ref class_name, declare and define the virtual run method, and register
  *   itself to the framework
  */
-#define TEST_F(class_name, test_name)                                 \
+#define TEST_F(class_name, test_name) TAGGED_TEST_F(class_name, test_name, "")
+
+/*!
+ * @brief Same as TEST_F, with @p tags used by the --tag option
+ *
+ * @p tags is a string literal, with the tags separated by spaces or commas
+ */
+#define TAGGED_TEST_F(class_name, test_name, tags)                    \
     class class_name##test_name : public class_name                   \
     {                                                                 \
     public:                                                           \
@@ -726,7 +5486,7 @@ inline int run_all()
     };                                                                \
     static int var##class_name##test_name =                           \
         corgi::test::detail::register_fixture<class_name##test_name>( \
-            #class_name, #test_name);                                 \
+            #class_name, #test_name, tags);                           \
     void class_name##test_name::run()
 
 /*!
@@ -736,11 +5496,78 @@ inline int run_all()
  * actually not be a string for it to works. The idea is to create an useless
  * variable so I can call the register function.
  */
-#define TEST(group_name, function_name)                                       \
+#define TEST(group_name, function_name) \
+    TAGGED_TEST(group_name, function_name, "")
+
+/*!
+ * @brief Same as TEST, with @p tags used by the --tag option
+ *
+ * @p tags is a string literal, with the tags separated by spaces or commas
+ */
+#define TAGGED_TEST(group_name, function_name, tags)                          \
+    void       group_name##_##function_name();                                \
+    static int var##group_name##function_name =                               \
+        corgi::test::detail::register_function(                               \
+            &group_name##_##function_name, #function_name, #group_name, tags); \
+    void group_name##_##function_name()
+
+/*!
+ * @brief Defines a property : a test run once for every case, drawing its
+ * inputs with corgi::test::draw
+ *
+ * A failing case is shrunk to the simplest one still failing, and reported
+ * with the values it drew and the seed reproducing it. See
+ * corgi::test::options::property_cases
+ */
+#define PROPERTY(group_name, property_name)                                   \
+    void group_name##_##property_name##_property();                           \
+    TEST(group_name, property_name)                                           \
+    {                                                                         \
+        corgi::test::detail::check_property(                                  \
+            #group_name "." #property_name,                                   \
+            &group_name##_##property_name##_property);                        \
+    }                                                                         \
+    void group_name##_##property_name##_property()
+
+#ifdef CORGI_TEST_HAS_ASYNC
+/*!
+ * @brief Defines a test whose body is a coroutine, returning a
+ * corgi::test::task<>
+ *
+ * The body can co_await corgi::test::sleep_for, readable, writable, wait, and
+ * other tasks. When tests run one at a time, consecutive TEST_ASYNC tests
+ * start together on one event loop, and overlap while they wait. Only
+ * available on Linux, in C++20
+ */
+#    define TEST_ASYNC(group_name, function_name)                             \
+        corgi::test::task<> group_name##_##function_name##_async();           \
+        static const corgi::test::detail::async_test_body                     \
+            async##group_name##function_name {                                \
+                {&corgi::test::detail::run_async_tests},                      \
+                &group_name##_##function_name##_async};                       \
+        void group_name##_##function_name()                                   \
+        {                                                                     \
+            corgi::test::detail::run_async_alone(                             \
+                async##group_name##function_name);                            \
+        }                                                                     \
+        static int var##group_name##function_name =                           \
+            corgi::test::detail::register_async(                              \
+                &group_name##_##function_name,                                \
+                async##group_name##function_name, #function_name,             \
+                #group_name);                                                 \
+        corgi::test::task<> group_name##_##function_name##_async()
+#endif
+
+/*!
+ * @brief Same as TEST, with a test timing out after @p timeout, a
+ * std::chrono duration. See corgi::test::options::timeout
+ */
+#define TIMED_TEST(group_name, function_name, timeout)                        \
     void       group_name##_##function_name();                                \
     static int var##group_name##function_name =                               \
-        corgi::test::detail::register_function(&group_name##_##function_name, \
-                                               #function_name, #group_name);  \
+        corgi::test::detail::register_function(                               \
+            &group_name##_##function_name, #function_name, #group_name, "",   \
+            std::chrono::duration_cast<std::chrono::milliseconds>(timeout));  \
     void group_name##_##function_name()
 
 #define assert_that(value, expected)                                      \
@@ -753,6 +5580,45 @@ inline int run_all()
 #define check_non_equals(value1, value2) \
     corgi::test::detail::check_non_equals_(value1, value2, __FILE__, __LINE__)
 
+/**
+ * @brief Checks that two contiguous ranges of the same type and size hold
+ * equal elements
+ */
+#define check_range_equals(actual, expected)                                 \
+    corgi::test::detail::check_range_(actual, expected,                      \
+                                      corgi::test::detail::exact_match {},   \
+                                      #actual, #expected, __FILE__, __LINE__)
+
+/**
+ * @brief Checks that two ranges of numbers are equal, or close enough : at
+ * most @p absolute apart, or @p relative times the largest of both
+ */
+#define check_range_near(actual, expected, absolute, relative)           \
+    corgi::test::detail::check_range_(                                   \
+        actual, expected,                                                \
+        corgi::test::detail::near_match {static_cast<double>(absolute),  \
+                                         static_cast<double>(relative)}, \
+        #actual, #expected, __FILE__, __LINE__)
+
+/**
+ * @brief Checks that two ranges of floating point numbers are at most
+ * @p max_ulps representable values apart
+ */
+#define check_range_ulps(actual, expected, max_ulps) \
+    corgi::test::detail::check_range_(               \
+        actual, expected,                            \
+        corgi::test::detail::ulp_match {             \
+            static_cast<std::uint64_t>(max_ulps)},   \
+        #actual, #expected, __FILE__, __LINE__)
+
+/**
+ * @brief Checks that the test body made at most @p maximum heap allocations
+ * since it started. Needs CORGI_TEST_TRACK_ALLOCATIONS to be defined in one
+ * translation unit.
+ */
+#define check_max_allocations(maximum) \
+    corgi::test::detail::check_max_allocations_(maximum, __FILE__, __LINE__)
+
 /**
  * @brief Checks if @p statement throws an exception of type @p type.
  *
@@ -773,23 +5639,8 @@ inline int run_all()
         {                                                                     \
         }                                                                     \
         if(!has_thrown)                                                       \
-        {                                                                     \
-            corgi::test::detail::write_line("\n        ! Error : ",           \
-                                            corgi::test::detail::color::Red); \
-            corgi::test::detail::write("            * file :     ",           \
-                                       corgi::test::detail::color::Cyan);     \
-            corgi::test::detail::write_line(                                  \
-                __FILE__, corgi::test::detail::color::Yellow);                \
-            corgi::test::detail::write("            * line :     ",           \
-                                       corgi::test::detail::color::Cyan);     \
-            corgi::test::detail::write_line(                                  \
-                std::to_string(__LINE__),                                     \
-                corgi::test::detail::color::Magenta);                         \
-            corgi::test::detail::write(                                       \
-                "            * No exception was thrown \n",                   \
-                corgi::test::detail::color::Cyan);                            \
-            corgi::test::detail::error += 1;                                  \
-        }                                                                     \
+            corgi::test::detail::log_throw_error(__FILE__, __LINE__,          \
+                                                 "No exception was thrown");  \
     }
 
 /**
@@ -809,23 +5660,8 @@ inline int run_all()
             has_thrown = true;                                                \
         }                                                                     \
         if(!has_thrown)                                                       \
-        {                                                                     \
-            corgi::test::detail::write_line("\n        ! Error : ",           \
-                                            corgi::test::detail::color::Red); \
-            corgi::test::detail::write("            * file :     ",           \
-                                       corgi::test::detail::color::Cyan);     \
-            corgi::test::detail::write_line(                                  \
-                __FILE__, corgi::test::detail::color::Yellow);                \
-            corgi::test::detail::write("            * line :     ",           \
-                                       corgi::test::detail::color::Cyan);     \
-            corgi::test::detail::write_line(                                  \
-                std::to_string(__LINE__),                                     \
-                corgi::test::detail::color::Magenta);                         \
-            corgi::test::detail::write(                                       \
-                "            * No exception was thrown \n",                   \
-                corgi::test::detail::color::Cyan);                            \
-            corgi::test::detail::error += 1;                                  \
-        }                                                                     \
+            corgi::test::detail::log_throw_error(__FILE__, __LINE__,          \
+                                                 "No exception was thrown");  \
     }
 
 #define check_true(statement)                       \
@@ -855,24 +5691,13 @@ inline int run_all()
             has_thrown = true;                                                \
         }                                                                     \
         if(has_thrown)                                                        \
-        {                                                                     \
-            corgi::test::detail::write_line("\n        ! Error : ",           \
-                                            corgi::test::detail::color::Red); \
-            corgi::test::detail::write("            * file :     ",           \
-                                       corgi::test::detail::color::Cyan);     \
-            corgi::test::detail::write_line(                                  \
-                __FILE__, corgi::test::detail::color::Yellow);                \
-            corgi::test::detail::write("            * line :     ",           \
-                                       corgi::test::detail::color::Cyan);     \
-            corgi::test::detail::write_line(                                  \
-                std::to_string(__LINE__),                                     \
-                corgi::test::detail::color::Magenta);                         \
-            corgi::test::detail::write(                                       \
-                "            * An exception was thrown \n",                   \
-                corgi::test::detail::color::Cyan);                            \
-            corgi::test::detail::error += 1;                                  \
-        }                                                                     \
+            corgi::test::detail::log_throw_error(__FILE__, __LINE__,          \
+                                                 "An exception was thrown");  \
     }
 // namespace test
 }    // namespace test
 }    // namespace corgi
+
+#ifdef CORGI_TEST_TRACK_ALLOCATIONS
+#    include <corgi/test/detail/allocation_hooks.h>
+#endif
@@ -0,0 +1,46 @@
+// Implements corgi/test/light.h once, so the files including it don't have to
+// parse corgi/test/test.h
+
+#include <corgi/test/runtime.h>
+#include <corgi/test/test.h>
+
+namespace corgi
+{
+namespace test
+{
+namespace runtime
+{
+int register_test(void (*function)(),
+                  std::string_view name,
+                  std::string_view group,
+                  std::string_view tags)
+{
+    return detail::register_function(function, name, group, tags);
+}
+
+int run_all(int argc, char** argv)
+{
+    return corgi::test::run_all(argc, argv);
+}
+
+bool silence_failure(const char* file, int line)
+{
+    return detail::silence_failure(file, line);
+}
+
+void log_comparison_error(const char*        check,
+                          const std::string& val1,
+                          const std::string& val2,
+                          const char*        file,
+                          int                line)
+{
+    detail::log_comparison_error(check, val1, val2, file, line);
+}
+
+void log_throw_error(const char* file, int line, const char* what)
+{
+    detail::log_throw_error(file, line, what);
+}
+}    // namespace runtime
+}    // namespace test
+}    // namespace corgi
@@ -0,0 +1,34 @@
+// Measures what including corgi/test/test.h or corgi/test/light.h costs to
+// every test file, by having the compiler check the syntax of a file holding a
+// single test. The compiler and paths come from CMake
+#include <corgi/test/test.h>
+
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+auto parse(const std::string& file)
+{
+    const std::string command = "\"" CORGI_TEST_COMPILER "\" -std=c++20 "
+                                "-fsyntax-only -I\"" CORGI_TEST_INCLUDE_DIR
+                                "\" \"" CORGI_TEST_SOURCE_DIR "/" +
+                                file + "\"";
+
+    return [command]()
+    {
+        if(std::system(command.c_str()) != 0)
+            throw std::runtime_error("Could not compile : " + command);
+    };
+}
+}    // namespace
+
+int main(int argc, char** argv)
+{
+    corgi::test::add_benchmark("parsing a test file", 5,
+                               parse("full_header.cpp"), "corgi/test/test.h",
+                               parse("light_header.cpp"), "corgi/test/light.h");
+
+    return corgi::test::run_all(argc, argv);
+}
@@ -0,0 +1,8 @@
+// Parsed by the compile time benchmark, never built
+#include <corgi/test/test.h>
+
+TEST(compile_time, full_header)
+{
+    check_equals(1 + 1, 2);
+    check_throw(throw 1, int);
+}
@@ -0,0 +1,8 @@
+// Parsed by the compile time benchmark, never built
+#include <corgi/test/light.h>
+
+TEST(compile_time, light_header)
+{
+    check_equals(1 + 1, 2);
+    check_throw(throw 1, int);
+}
@@ -0,0 +1,22 @@
+// Only sees corgi/test/light.h, like a test file built against the runtime
+// library. See test_light.cpp for the failures
+#include <corgi/test/light.h>
+
+#include <stdexcept>
+#include <string>
+
+TAGGED_TEST(light, checks_pass, "light")
+{
+    check_equals(1 + 1, 2);
+    check_non_equals(std::string("corgi"), std::string("test"));
+    check_throw(throw std::runtime_error("thrown"), std::runtime_error);
+    check_any_throw(throw 1);
+    check_no_throw(static_cast<void>(0));
+}
+
+void light_failing_checks()
+{
+    check_equals(1, 2);
+    check_non_equals(std::string("same"), std::string("same"));
+    check_no_throw(throw 1);
+}
@@ -1,32 +1,54 @@
+// The test executable counts its allocations, and this is the only file
+// allowed to ask for it
+#define CORGI_TEST_TRACK_ALLOCATIONS
 #include <corgi/test/test.h>
 
-std::vector<int> v1(10000);
-std::vector<int> v2(20000);
-
-void first_function()
+namespace
+{
+std::vector<int> random_values(size_t size)
 {
-    std::sort(v1.begin(), v1.end());
+    std::vector<int> values(size);
+    std::generate(values.begin(), values.end(), std::rand);
+    return values;
 }
 
-void second_function()
+// The values are copied so every call sorts the same unsorted data, instead
+// of sorting already sorted values after the first call
+template<class Sort>
+auto sort_copy(Sort sort)
 {
-    std::sort(v2.begin(), v2.end());
+    return [sort](const std::vector<int>& values)
+    {
+        auto copy = values;
+        sort(copy.begin(), copy.end());
+        corgi::test::do_not_optimize(copy.data());
+        corgi::test::clobber_memory();
+    };
 }
+}    // namespace
 
-int main()
+int main(int argc, char** argv)
 {
     std::srand(unsigned(std::time(nullptr)));
-    std::generate(v1.begin(), v1.end(), std::rand);
-    std::generate(v2.begin(), v2.end(), std::rand);
+
+    const auto values = random_values(10000);
+    const auto sort   = sort_copy([](auto first, auto last)
+                                { std::sort(first, last); });
+    const auto stable = sort_copy([](auto first, auto last)
+                                  { std::stable_sort(first, last); });
 
     // I'm considering going this way instead of the TEST macro
-    corgi::test::add_benchmark("first_benchmark", 10, first_function, "small vector",
-                               second_function, "big_vector");
+    corgi::test::add_benchmark(
+        "sorting", 10, [&]() { sort(values); }, "std::sort",
+        [&]() { stable(values); }, "std::stable_sort");
+
+    corgi::test::add_range_benchmark("std::sort", 10, {1000, 16000, 4},
+                                     &random_values, sort);
 
     corgi::test::add_test("group_test", "name_test",
                           []() -> void { assert_that(true, corgi::test::equals(true)); });
 
-    return corgi::test::run_all();
+    return corgi::test::run_all(argc, argv);
 }
 /**
  * 
@@ -35,4 +57,4 @@ int main()
 +------------+----------+----------+-----------+
 |            |          |          |           |
 +------------+----------+----------+-----------+
-*/
\ No newline at end of file
+*/
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <corgi/test/test.h>
+
+#include <mutex>
+
+/*!
+ * @brief Sets how many failures of a test are reported in full for as long
+ * as it lives, then puts the previous value back
+ *
+ * Keeps the tests counting the reports from depending on the command line.
+ * Scopes wait for each other, so tests running in parallel never restore a
+ * value another one set.
+ */
+class reported_failures_scope
+{
+public:
+    explicit reported_failures_scope(int reported_failures)
+        : _lock(mutex())
+        , _previous(corgi::test::detail::reported_failures.exchange(
+              reported_failures))
+    {
+    }
+
+    reported_failures_scope(const reported_failures_scope&) = delete;
+    reported_failures_scope&
+    operator=(const reported_failures_scope&) = delete;
+
+    ~reported_failures_scope()
+    {
+        corgi::test::detail::reported_failures = _previous;
+    }
+
+private:
+    static std::mutex& mutex()
+    {
+        static std::mutex instance;
+        return instance;
+    }
+
+    std::lock_guard<std::mutex> _lock;
+    int                         _previous;
+};
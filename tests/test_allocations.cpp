@@ -0,0 +1,107 @@
+#include <corgi/test/test.h>
+
+#include <memory>
+#include <vector>
+
+using namespace corgi::test;
+
+// main.cpp defines CORGI_TEST_TRACK_ALLOCATIONS, so every allocation of this
+// executable is counted
+
+TEST(allocations, tracking_is_installed)
+{
+    assert_that(detail::allocation_tracking, equals(true));
+}
+
+TEST(allocations, scope_counts_allocations_and_bytes)
+{
+    detail::allocation_scope scope;
+    scope.start();
+
+    auto first  = std::make_unique<int[]>(16);
+    auto second = std::make_unique<int[]>(16);
+    second.reset();
+
+    const auto stats = scope.stats();
+    check_equals(stats.allocations, std::size_t(2));
+    check_equals(stats.bytes, 32 * sizeof(int));
+    check_equals(stats.peak_bytes, 32 * sizeof(int));
+}
+
+TEST(allocations, peak_only_counts_bytes_alive_together)
+{
+    detail::allocation_scope scope;
+    scope.start();
+
+    for(int i = 0; i < 4; i++)
+        auto block = std::make_unique<char[]>(100);
+
+    const auto stats = scope.stats();
+    check_equals(stats.allocations, std::size_t(4));
+    check_equals(stats.bytes, std::size_t(400));
+    check_equals(stats.peak_bytes, std::size_t(100));
+}
+
+TEST(allocations, nested_scope_keeps_the_outer_peak)
+{
+    detail::allocation_scope outer;
+    outer.start();
+
+    std::make_unique<char[]>(1000).reset();
+    {
+        detail::allocation_scope inner;
+        inner.start();
+        auto block = std::make_unique<char[]>(10);
+        check_equals(inner.stats().peak_bytes, std::size_t(10));
+    }
+
+    check_equals(outer.stats().peak_bytes, std::size_t(1000));
+}
+
+TEST(allocations, budget_is_respected)
+{
+    std::vector<int> values;
+    values.reserve(64);
+
+    for(int i = 0; i < 64; i++)
+        values.push_back(i);
+
+    check_max_allocations(1);
+}
+
+TEST(allocations, budget_overrun_fails_the_test)
+{
+    detail::test_context context;
+    auto* previous = std::exchange(detail::current_context, &context);
+
+    std::string output;
+    {
+        detail::capture_output capture(output);
+        context.allocations.start();
+        auto first  = std::make_unique<int>(1);
+        auto second = std::make_unique<int>(2);
+        check_max_allocations(1);
+    }
+
+    detail::current_context = previous;
+    check_equals(context.errors, 1);
+}
+
+TEST(allocations, benchmarks_report_allocations_per_call)
+{
+    benchmark_settings settings;
+    settings.warmup_time = std::chrono::microseconds(100);
+    settings.sample_time = std::chrono::microseconds(100);
+
+    const auto result = run_benchmark_function(
+        []()
+        {
+            auto value = std::make_unique<long>(42);
+            do_not_optimize(*value);
+        },
+        3, settings);
+
+    assert_that(result.allocations, almost_equals(1.0, 1e-9));
+    assert_that(result.allocated_bytes,
+                almost_equals(static_cast<double>(sizeof(long)), 1e-9));
+}
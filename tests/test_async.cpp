@@ -0,0 +1,229 @@
+#include <corgi/test/test.h>
+
+#ifdef CORGI_TEST_HAS_ASYNC
+
+#    include <chrono>
+#    include <functional>
+#    include <future>
+#    include <stdexcept>
+#    include <string>
+#    include <thread>
+#    include <vector>
+
+#    include <unistd.h>
+
+using namespace corgi::test;
+using namespace std::chrono_literals;
+
+namespace
+{
+task<> sleeping()
+{
+    co_await sleep_for(50ms);
+}
+
+task<> failing_after_sleep()
+{
+    co_await sleep_for(10ms);
+    check_equals(1, 2);
+}
+
+task<> throwing_after_sleep()
+{
+    co_await sleep_for(1ms);
+    throw std::runtime_error("thrown late");
+}
+
+task<> stuck()
+{
+    co_await std::suspend_always {};
+}
+
+task<int> sum_later(int a, int b)
+{
+    co_await sleep_for(1ms);
+    co_return a + b;
+}
+
+task<int> throwing_task()
+{
+    co_await sleep_for(1ms);
+    throw std::runtime_error("nested");
+}
+
+task<> allocating_while_others_wait()
+{
+    co_await sleep_for(1ms);
+    for(int i = 0; i < 100; i++)
+        delete new int(i);
+}
+
+task<> within_its_budget()
+{
+    co_await sleep_for(5ms);
+    check_max_allocations(50);
+}
+
+/*!
+ * @brief What TEST_ASYNC registers for a test whose coroutine is @p start
+ */
+detail::async_test_body async_test(task<> (*start)())
+{
+    return {{&detail::run_async_tests}, start};
+}
+
+/*!
+ * @brief Runs @p bodies together, like consecutive TEST_ASYNC tests, and
+ * returns their results in order
+ */
+std::vector<detail::test_result>
+run_together(const std::vector<detail::async_test_body>& bodies)
+{
+    std::vector<detail::test_case> tests(bodies.size());
+    for(std::size_t i = 0; i < bodies.size(); i++)
+    {
+        tests[i].record.group = "async";
+        tests[i].record.name  = "test";
+        tests[i].record.async = &bodies[i];
+    }
+
+    std::vector<detail::test_result> results;
+    detail::run_async_tests(
+        tests.data(), tests.data() + tests.size(),
+        [&](const detail::test_case&, const detail::test_result& result)
+        { results.push_back(result); });
+    return results;
+}
+}    // namespace
+
+TEST(async, waiting_tests_overlap)
+{
+    const std::vector<detail::async_test_body> bodies(4, async_test(&sleeping));
+
+    const auto start   = std::chrono::steady_clock::now();
+    const auto results = run_together(bodies);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    check_equals(results.size(), std::size_t(4));
+    for(const auto& result : results)
+    {
+        check_equals(result.errors, 0);
+        assert_that(result.time, greater_than(49999LL));
+    }
+    assert_that(elapsed, less_than(std::chrono::nanoseconds(150ms)));
+}
+
+TEST(async, failures_count_for_their_test)
+{
+    const std::vector<detail::async_test_body> bodies {
+        async_test(&sleeping), async_test(&failing_after_sleep),
+        async_test(&throwing_after_sleep), async_test(&stuck)};
+
+    const auto results = run_together(bodies);
+
+    check_equals(results.size(), std::size_t(4));
+    check_equals(results[0].errors, 0);
+    check_equals(results[1].errors, 1);
+    check_equals(results[2].errors, 1);
+    check_equals(results[3].errors, 1);
+
+    check_equals(results[0].output.empty(), true);
+    check_non_equals(results[2].output.find("thrown late"), std::string::npos);
+    check_non_equals(results[3].output.find("without waiting"),
+                     std::string::npos);
+}
+
+TEST(async, allocations_only_count_while_resumed)
+{
+    if(!detail::allocation_tracking)
+        return;
+
+    const std::vector<detail::async_test_body> bodies {
+        async_test(&within_its_budget),
+        async_test(&allocating_while_others_wait)};
+
+    const auto results = run_together(bodies);
+
+    check_equals(results.size(), std::size_t(2));
+    check_equals(results[0].errors, 0);
+    assert_that(results[0].allocations.allocations, less_than(std::size_t(51)));
+    assert_that(results[1].allocations.allocations,
+                greater_than(std::size_t(99)));
+}
+
+TEST(async, lone_tests_report_their_failures)
+{
+    const detail::async_test_body body = async_test(&failing_after_sleep);
+    const std::function<void()>   run = [&]()
+    { detail::run_async_alone(body); };
+
+    detail::test_case test;
+    test.record.group    = "async";
+    test.record.name     = "alone";
+    test.record.callable = &run;
+
+    detail::test_result result;
+    std::string         output;
+    {
+        detail::capture_output capture(output);
+        detail::run_test(test, result);
+    }
+    check_equals(result.errors, 1);
+}
+
+TEST(async, awaiting_outside_test_async_throws)
+{
+    check_throw(sleep_for(1ms).await_suspend(std::noop_coroutine()),
+                std::logic_error);
+}
+
+TEST_ASYNC(async, sleep_for)
+{
+    const auto start = std::chrono::steady_clock::now();
+    co_await sleep_for(20ms);
+    assert_that(std::chrono::steady_clock::now() - start,
+                greater_than(std::chrono::nanoseconds(19ms)));
+}
+
+TEST_ASYNC(async, readable_pipe)
+{
+    int fds[2];
+    check_equals(::pipe(fds), 0);
+
+    co_await writable(fds[1]);
+    std::thread writer(
+        [&]()
+        {
+            std::this_thread::sleep_for(10ms);
+            check_equals(::write(fds[1], "x", 1), ssize_t(1));
+        });
+
+    co_await readable(fds[0]);
+    char read {0};
+    check_equals(::read(fds[0], &read, 1), ssize_t(1));
+    check_equals(read, 'x');
+
+    writer.join();
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST_ASYNC(async, futures)
+{
+    auto future = std::async(std::launch::async,
+                             []()
+                             {
+                                 std::this_thread::sleep_for(10ms);
+                                 return 42;
+                             });
+
+    check_equals(co_await wait(future), 42);
+}
+
+TEST_ASYNC(async, nested_tasks)
+{
+    check_equals(co_await sum_later(1, 2), 3);
+    check_throw(co_await throwing_task(), std::runtime_error);
+}
+
+#endif
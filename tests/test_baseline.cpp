@@ -0,0 +1,163 @@
+#include <corgi/test/test.h>
+
+#include <cstdio>
+
+using namespace corgi::test;
+
+namespace
+{
+std::vector<benchmark> make_benchmarks()
+{
+    std::vector<benchmark> result;
+    result.emplace_back("sort", 2,
+                        std::vector<benchmark_candidate> {
+                            {"std::sort", []() {}}, {"bubble sort", []() {}}});
+    result.emplace_back("hash", 2,
+                        std::vector<benchmark_candidate> {{"fnv", []() {}}});
+    result.back().tolerance = 0.5;
+    return result;
+}
+
+std::vector<detail::baseline_entry> make_entries(double sort, double bubble,
+                                                 double hash)
+{
+    std::vector<benchmark_result> results(2);
+    results[0].results.resize(2);
+    results[0].results[0].median_time = sort;
+    results[0].results[1].median_time = bubble;
+    results[1].results.resize(1);
+    results[1].results[0].median_time = hash;
+
+    std::vector<detail::baseline_entry> entries;
+    detail::append_baseline_entries(entries, make_benchmarks(), results);
+    return entries;
+}
+}    // namespace
+
+TEST(baseline, saved_baseline_reads_back)
+{
+    std::FILE* file = std::tmpfile();
+    detail::write_baseline(file, make_entries(100.0, 2500.5, 42.0));
+    std::rewind(file);
+
+    const auto baseline = detail::read_baseline(file);
+    std::fclose(file);
+
+    check_equals(baseline.size(), std::size_t(3));
+    check_equals(baseline.at("sort\tstd::sort"), 100.0);
+    check_equals(baseline.at("sort\tbubble sort"), 2500.5);
+    check_equals(baseline.at("hash\tfnv"), 42.0);
+}
+
+TEST(baseline, names_are_escaped)
+{
+    const std::vector<detail::baseline_entry> entries {
+        {"#odd\tname", "new\nline \\ back", 12.0, {}}};
+
+    std::FILE* file = std::tmpfile();
+    detail::write_baseline(file, entries);
+    std::rewind(file);
+
+    const auto baseline = detail::read_baseline(file);
+    std::fclose(file);
+
+    check_equals(baseline.size(), std::size_t(1));
+    check_equals(baseline.at(detail::baseline_key("#odd\tname",
+                                                  "new\nline \\ back")),
+                 12.0);
+}
+
+TEST(baseline, malformed_baseline_throws)
+{
+    for(const char* text : {"# comment\nsort\tstd::sort\tfast\n",
+                            "sort\tstd::sort\t-1\n", "sort\tstd::sort\tnan\n",
+                            "sort\tstd\t:sort\t12\n"})
+    {
+        std::FILE* file = std::tmpfile();
+        std::fputs(text, file);
+        std::rewind(file);
+
+        check_throw(detail::read_baseline(file), std::runtime_error);
+        std::fclose(file);
+    }
+}
+
+TEST(baseline, slowdown_beyond_tolerance_is_a_regression)
+{
+    const detail::baseline reference {{"sort\tstd::sort", 100.0},
+                                      {"sort\tbubble sort", 1000.0},
+                                      {"hash\tfnv", 40.0}};
+
+    const auto comparisons =
+        detail::compare_to_baseline(make_entries(130.0, 1050.0, 55.0),
+                                    reference, 0.1);
+
+    check_equals(comparisons.size(), std::size_t(3));
+    check_equals(comparisons[0].regressed(), true);     // 30% > 10%
+    check_equals(comparisons[1].regressed(), false);    // 5% <= 10%
+    check_equals(comparisons[2].regressed(), false);    // 37.5% <= 50%
+    check_equals(comparisons[2].tolerance, 0.5);
+}
+
+TEST(baseline, candidates_missing_from_the_baseline_are_skipped)
+{
+    const detail::baseline reference {{"sort\tstd::sort", 100.0}};
+
+    const auto comparisons =
+        detail::compare_to_baseline(make_entries(90.0, 1000.0, 40.0),
+                                    reference, 0.1);
+
+    check_equals(comparisons.size(), std::size_t(1));
+    check_equals(comparisons[0].candidate, std::string("std::sort"));
+    check_equals(comparisons[0].regressed(), false);
+}
+
+TEST(baseline, baseline_medians_of_zero_are_skipped)
+{
+    const detail::baseline reference {{"sort\tstd::sort", 0.0},
+                                      {"hash\tfnv", 40.0}};
+
+    const auto comparisons =
+        detail::compare_to_baseline(make_entries(90.0, 1000.0, 40.0),
+                                    reference, 0.1);
+
+    check_equals(comparisons.size(), std::size_t(1));
+    check_equals(comparisons[0].candidate, std::string("fnv"));
+}
+
+TEST(baseline, range_and_threaded_benchmarks_are_saved)
+{
+    std::vector<range_benchmark> ranges(1);
+    ranges[0].name = "sort range";
+    std::vector<range_benchmark_result> range_results(1);
+    range_results[0].sizes = {16, 256};
+    range_results[0].results.resize(2);
+    range_results[0].results[0].median_time = 10.0;
+    range_results[0].results[1].median_time = 300.0;
+
+    std::vector<threaded_benchmark> threaded(1);
+    threaded[0].name = "counter";
+    std::vector<threaded_benchmark_result> threaded_results(1);
+    threaded_results[0].scaling.resize(2);
+    threaded_results[0].scaling[0].threads        = 1;
+    threaded_results[0].scaling[0].median_latency = 5.0;
+    threaded_results[0].scaling[1].threads        = 2;
+    threaded_results[0].scaling[1].median_latency = 8.0;
+
+    std::vector<detail::baseline_entry> entries;
+    detail::append_baseline_entries(entries, ranges, range_results);
+    detail::append_baseline_entries(entries, threaded, threaded_results);
+
+    std::FILE* file = std::tmpfile();
+    detail::write_baseline(file, entries);
+    std::rewind(file);
+
+    const auto baseline = detail::read_baseline(file);
+    std::fclose(file);
+
+    check_equals(baseline.size(), std::size_t(4));
+    check_equals(baseline.at("sort range\tsize 16"), 10.0);
+    check_equals(baseline.at("sort range\tsize 256"), 300.0);
+    check_equals(baseline.at("counter\tthreads 1"), 5.0);
+    check_equals(baseline.at("counter\tthreads 2"), 8.0);
+}
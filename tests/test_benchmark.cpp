@@ -0,0 +1,205 @@
+#include <corgi/test/test.h>
+
+using namespace corgi::test;
+
+namespace
+{
+benchmark_function_result make_result(double center, double spread)
+{
+    benchmark_function_result result;
+    for(int i = 0; i < 30; i++)
+        result.samples.push_back(center + spread * ((i % 7) - 3));
+    result.median_time = detail::median(result.samples);
+    return result;
+}
+}    // namespace
+
+TEST(benchmark, fastest_candidate_is_the_lowest_median)
+{
+    benchmark_result result;
+    result.results = {make_result(200.0, 1.0), make_result(100.0, 1.0),
+                      make_result(300.0, 1.0)};
+
+    detail::compare_candidates(result);
+
+    check_equals(result.fastest, std::size_t(1));
+    check_equals(result.comparisons.size(), std::size_t(2));
+    check_equals(result.comparisons[0].candidate, std::size_t(0));
+    check_equals(result.comparisons[1].candidate, std::size_t(2));
+    assert_that(result.comparisons[0].slowdown.ratio, almost_equals(2.0, 0.01));
+    assert_that(result.comparisons[0].slowdown.significant(), equals(true));
+}
+
+TEST(benchmark, overlapping_samples_are_not_significant)
+{
+    benchmark_result result;
+    result.results = {make_result(100.0, 20.0), make_result(101.0, 20.0)};
+
+    detail::compare_candidates(result);
+
+    check_equals(result.comparisons.size(), std::size_t(1));
+    assert_that(result.comparisons[0].slowdown.significant(), equals(false));
+}
+
+TEST(benchmark, compares_any_number_of_candidates)
+{
+    benchmark_settings settings;
+    settings.warmup_time = std::chrono::microseconds(100);
+    settings.sample_time = std::chrono::microseconds(100);
+
+    volatile int value = 0;
+    benchmark    three_way("three_way", 3,
+                           {{"a", [&]() { value = value + 1; }},
+                            {"b", [&]() { value = value + 2; }},
+                            {"c", [&]() { value = value + 3; }}});
+
+    const auto result = run_benchmark(three_way, settings);
+
+    check_equals(result.results.size(), std::size_t(3));
+    check_equals(result.comparisons.size(), std::size_t(2));
+}
+
+TEST(benchmark, candidates_accept_any_callable)
+{
+    int  calls = 0;
+    auto count = [&calls]() { calls++; };
+
+    benchmark_candidate candidate("lambda", count);
+    candidate.run_batch(42);
+
+    check_equals(calls, 42);
+}
+
+TEST(benchmark, hardware_counters_degrade_to_timings)
+{
+    benchmark_settings settings;
+    settings.warmup_time       = std::chrono::microseconds(100);
+    settings.sample_time       = std::chrono::microseconds(100);
+    settings.hardware_counters = true;
+
+    int        value  = 0;
+    const auto result = run_benchmark_function(
+        [&]()
+        {
+            value++;
+            do_not_optimize(value);
+        },
+        3, settings);
+
+    // Containers usually forbid perf events, so both outcomes are fine as
+    // long as the timings are there and the counters make sense
+    check_equals(result.samples.size(), std::size_t(3));
+    if(result.counters.instructions)
+        assert_that(*result.counters.instructions > 0.0, equals(true));
+}
+
+TEST(benchmark, ipc_needs_cycles_and_instructions)
+{
+    hardware_counters counters;
+    assert_that(counters.available(), equals(false));
+    assert_that(counters.ipc().has_value(), equals(false));
+
+    counters.cycles       = 100.0;
+    counters.instructions = 250.0;
+    assert_that(*counters.ipc(), almost_equals(2.5, 1e-9));
+}
+
+TEST(benchmark, range_goes_up_geometrically_to_the_last_size)
+{
+    using sizes = std::vector<std::size_t>;
+
+    assert_that(benchmark_range({1000, 64000, 4}).sizes() ==
+                    sizes({1000, 4000, 16000, 64000}),
+                equals(true));
+    assert_that(benchmark_range({10, 50, 2}).sizes() == sizes({10, 20, 40, 50}),
+                equals(true));
+    assert_that(benchmark_range({8, 8, 2}).sizes() == sizes({8}),
+                equals(true));
+}
+
+TEST(benchmark, range_setup_runs_once_per_size_outside_the_timing)
+{
+    benchmark_settings settings;
+    settings.warmup_time = std::chrono::microseconds(100);
+    settings.sample_time = std::chrono::microseconds(100);
+
+    std::vector<std::size_t> setups;
+
+    range_benchmark bench;
+    bench.name       = "sum";
+    bench.repetition = 3;
+    bench.range      = {16, 256, 4};
+    bench.prepare    = [&](std::size_t size)
+    {
+        setups.push_back(size);
+        return detail::make_batch_function(
+            [size]()
+            {
+                std::size_t sum = 0;
+                for(std::size_t i = 0; i < size; i++)
+                    do_not_optimize(sum += i);
+            });
+    };
+
+    const auto result = run_range_benchmark(bench, settings);
+
+    assert_that(setups == std::vector<std::size_t>({16, 64, 256}),
+                equals(true));
+    assert_that(result.sizes == setups, equals(true));
+    check_equals(result.results.size(), std::size_t(3));
+}
+
+TEST(benchmark, thread_counts_double_up_to_the_maximum)
+{
+    threaded_benchmark bench;
+    bench.max_threads = 6;
+    assert_that(bench.thread_counts() == std::vector<std::size_t>({1, 2, 4, 6}),
+                equals(true));
+
+    bench.max_threads = 1;
+    assert_that(bench.thread_counts() == std::vector<std::size_t>({1}),
+                equals(true));
+}
+
+TEST(benchmark, threaded_benchmark_runs_every_thread)
+{
+    benchmark_settings settings;
+    settings.warmup_time = std::chrono::microseconds(100);
+    settings.sample_time = std::chrono::microseconds(100);
+
+    std::atomic<std::size_t> calls {0};
+    std::atomic<std::size_t> highest_thread {0};
+
+    // Built here rather than registered, so the benchmarks of the executable
+    // are left alone
+    threaded_benchmark bench;
+    bench.name        = "counter";
+    bench.repetition  = 2;
+    bench.max_threads = 4;
+    bench.run_batch   = [&](std::size_t thread, std::size_t iterations)
+    {
+        auto call = [&, thread]()
+        {
+            calls.fetch_add(1, std::memory_order_relaxed);
+            if(thread > highest_thread.load())
+                highest_thread.store(thread);
+        };
+        return detail::time_batch(call, iterations);
+    };
+
+    const auto result = run_threaded_benchmark(bench, settings);
+
+    check_equals(result.scaling.size(), std::size_t(3));
+    check_equals(result.scaling.back().threads, std::size_t(4));
+    check_equals(highest_thread.load(), std::size_t(3));
+    assert_that(result.scaling.front().efficiency, almost_equals(1.0, 1e-9));
+
+    // The calibration calls come first, then every sample of every count
+    std::size_t measured = 0;
+    for(const auto& scaling : result.scaling)
+    {
+        measured += 2 * scaling.threads * scaling.iterations;
+        assert_that(scaling.throughput > 0.0, equals(true));
+    }
+    assert_that(calls.load() >= measured, equals(true));
+}
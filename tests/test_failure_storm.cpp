@@ -0,0 +1,113 @@
+#include <corgi/test/test.h>
+
+#include "reported_failures_scope.h"
+
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace corgi::test;
+
+namespace
+{
+/*!
+ * @brief Runs @p body like the runner would, and returns its errors and
+ * output
+ */
+std::pair<int, std::string> run_body(const std::function<void()>& body)
+{
+    detail::test_case test;
+    test.record.group    = "failure_storm";
+    test.record.name     = "body";
+    test.record.callable = &body;
+
+    detail::test_result result;
+    std::string         output;
+    {
+        detail::capture_output capture(output);
+        detail::run_test(test, result);
+    }
+    return {result.errors, output};
+}
+
+std::size_t count(const std::string& text, const std::string& pattern)
+{
+    std::size_t found {0};
+    for(auto i = text.find(pattern); i != std::string::npos;
+        i = text.find(pattern, i + 1))
+        found++;
+    return found;
+}
+}    // namespace
+
+TEST(failure_storm, only_the_first_failures_are_reported)
+{
+    reported_failures_scope scope(10);
+
+    const auto result = run_body(
+        []()
+        {
+            for(int i = 0; i < 100000; i++)
+                check_equals(i, -1);
+            assert_that(1, equals(2));
+        });
+
+    check_equals(result.first, 100001);
+    check_equals(count(result.second, "! Error"), std::size_t(10));
+
+    // Silenced failures are summed up by call site
+    check_non_equals(result.second.find("99991 more failures"),
+                     std::string::npos);
+    check_equals(count(result.second, "test_failure_storm.cpp:"),
+                 std::size_t(2));
+    check_non_equals(result.second.find(" : 99990"), std::string::npos);
+}
+
+TEST(failure_storm, threads_share_the_budget_of_their_test)
+{
+    reported_failures_scope scope(10);
+
+    const auto result = run_body(
+        []()
+        {
+            std::vector<std::thread> threads;
+            for(int i = 0; i < 4; i++)
+                threads.push_back(spawn(
+                    []()
+                    {
+                        for(int j = 0; j < 1000; j++)
+                            check_non_equals(j, j);
+                    }));
+
+            for(auto& thread : threads)
+                thread.join();
+        });
+
+    check_equals(result.first, 4000);
+    check_equals(count(result.second, "! Error"), std::size_t(10));
+    check_non_equals(result.second.find("3990 more failures"),
+                     std::string::npos);
+}
+
+TEST(failure_storm, passing_tests_have_no_summary)
+{
+    const auto result = run_body([]() { check_equals(1, 1); });
+
+    check_equals(result.first, 0);
+    check_equals(result.second.find("more failures"), std::string::npos);
+}
+
+TEST(failure_storm, option)
+{
+    char  name[] = "test";
+    char  value[] = "--max-reported-failures=3";
+    char* argv[] {name, value};
+
+    check_equals(parse_options(2, argv).reported_failures, 3);
+    check_equals(options {}.reported_failures, 10);
+
+    char too_large[] = "--max-reported-failures=4294967295";
+    argv[1]          = too_large;
+    check_throw(parse_options(2, argv), std::invalid_argument);
+}
@@ -0,0 +1,96 @@
+#include <corgi/test/test.h>
+
+using namespace corgi::test;
+
+TAGGED_TEST(filter, tagged_test, "fast, filter")
+{
+    check_equals(1, 1);
+}
+
+namespace
+{
+void empty_function() {}
+
+std::vector<detail::test_record> make_records()
+{
+    return {
+        {"math", "add", &empty_function, nullptr, nullptr, "fast"},
+        {"math", "mul", &empty_function, nullptr, nullptr, "slow gpu"},
+        {"io", "read", &empty_function, nullptr, nullptr, "slow"},
+        {"io", "write", &empty_function, nullptr, nullptr, ""},
+        {"mathematics", "pow", &empty_function, nullptr, nullptr, ""},
+    };
+}
+
+std::string names(const std::vector<detail::test_case>& tests)
+{
+    std::string result;
+    for(const auto& test : tests)
+    {
+        result += std::string(test.record.group) + "." +
+                  std::string(test.record.name) + " ";
+    }
+    return result;
+}
+}    // namespace
+
+TEST(filter, wildcards)
+{
+    const detail::test_record record {"math", "add", nullptr,
+                                      nullptr, nullptr, ""};
+
+    assert_that(detail::matches("math.add", record), equals(true));
+    assert_that(detail::matches("math.*", record), equals(true));
+    assert_that(detail::matches("*.a?d", record), equals(true));
+    assert_that(detail::matches("*", record), equals(true));
+    assert_that(detail::matches("math", record), equals(false));
+    assert_that(detail::matches("math.ad", record), equals(false));
+    assert_that(detail::matches("*.mul", record), equals(false));
+}
+
+TEST(filter, literal_group_only_selects_that_group)
+{
+    auto    records = make_records();
+    options run_options;
+    run_options.filters = {"math.*"};
+
+    check_equals(names(detail::select_tests(records, run_options)),
+                 std::string("math.add math.mul "));
+}
+
+TEST(filter, exclude_and_wildcard_group)
+{
+    auto    records = make_records();
+    options run_options;
+    run_options.filters  = {"*.*"};
+    run_options.excludes = {"io.*", "*.mul"};
+
+    check_equals(names(detail::select_tests(records, run_options)),
+                 std::string("math.add mathematics.pow "));
+}
+
+TEST(filter, tags)
+{
+    auto    records = make_records();
+    options run_options;
+    run_options.tags = {"slow"};
+
+    check_equals(names(detail::select_tests(records, run_options)),
+                 std::string("io.read math.mul "));
+
+    run_options.tags = {"gpu", "fast"};
+    check_equals(names(detail::select_tests(records, run_options)),
+                 std::string("math.add math.mul "));
+}
+
+TEST(filter, list_as_json)
+{
+    auto    records = make_records();
+    options run_options;
+    run_options.filters = {"math.mul"};
+
+    check_equals(
+        detail::list_tests(detail::select_tests(records, run_options)),
+        std::string("{\"tests\":[\n{\"group\":\"math\",\"name\":\"mul\","
+                    "\"fixture\":false,\"tags\":[\"slow\",\"gpu\"]}\n]}\n"));
+}
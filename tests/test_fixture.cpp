@@ -29,4 +29,25 @@ TEST_F(TestFixture, use_assert_that)
     assert_that(y, equals(10));
     assert_that(y, non_equals(2));
     assert_that(0.1f, almost_equals(0.09f, 0.0200f));
-}
\ No newline at end of file
+}
+
+class CountedFixture : public corgi::test::Test
+{
+public:
+    CountedFixture() { alive++; }
+    ~CountedFixture() override { alive--; }
+
+    // Fixtures are built on the thread running their test, which keeps the
+    // count right when tests run in parallel
+    static inline thread_local int alive = 0;
+};
+
+TEST_F(CountedFixture, built_only_when_running)
+{
+    check_equals(alive, 1);
+}
+
+TEST_F(CountedFixture, destroyed_after_each_test)
+{
+    check_equals(alive, 1);
+}
@@ -0,0 +1,122 @@
+#include <corgi/test/test.h>
+
+#include <cstdio>
+#include <stdexcept>
+
+using namespace corgi::test;
+
+namespace
+{
+detail::run_history read_text(const std::string& text)
+{
+    auto* file = std::tmpfile();
+    std::fwrite(text.data(), 1, text.size(), file);
+    std::rewind(file);
+
+    detail::run_history history;
+    try
+    {
+        history.read(file);
+    }
+    catch(...)
+    {
+        std::fclose(file);
+        throw;
+    }
+    std::fclose(file);
+    return history;
+}
+
+std::string names(const std::vector<detail::test_case>& tests)
+{
+    std::string result;
+    for(const auto& test : tests)
+        result += std::string(test.record.group) + "." +
+                  std::string(test.record.name) + "#" +
+                  std::to_string(test.index) + "/" +
+                  std::to_string(test.group_size) + " ";
+    return result;
+}
+}    // namespace
+
+TEST(history, is_written_and_read_back)
+{
+    detail::run_history history;
+    history.record("Math.add", 120, false);
+    history.record("Math.multiply", 4500, true);
+
+    auto* file = std::tmpfile();
+    history.write(file);
+    std::rewind(file);
+
+    detail::run_history loaded;
+    loaded.read(file);
+    std::fclose(file);
+
+    const auto* add      = loaded.find("Math.add");
+    const auto* multiply = loaded.find("Math.multiply");
+
+    check_equals(add != nullptr && multiply != nullptr, true);
+    check_equals(add->time, 120ll);
+    check_equals(add->failed, false);
+    check_equals(multiply->time, 4500ll);
+    check_equals(multiply->failed, true);
+    check_equals(loaded.find("Math.divide") == nullptr, true);
+}
+
+TEST(history, names_with_tabulations_keep_them)
+{
+    const auto history = read_text("# comment\nodd\tname\t10\tpassed\n");
+
+    check_equals(history.find("odd\tname") != nullptr, true);
+}
+
+TEST(history, invalid_lines_are_rejected)
+{
+    check_throw(read_text("Math.add\t12\n"), std::runtime_error);
+    check_throw(read_text("Math.add\tslow\tpassed\n"), std::runtime_error);
+    check_throw(read_text("Math.add\t12\tmaybe\n"), std::runtime_error);
+}
+
+TEST(history, longest_tasks_start_first)
+{
+    const long long times[] = {10, -1, 300, 20, -1, 300};
+
+    const auto order =
+        detail::longest_first(6, [&](std::size_t i) { return times[i]; });
+
+    std::string text;
+    for(auto i : order)
+        text += std::to_string(i) + " ";
+
+    // Tasks that never ran come first, ties keep their order
+    check_equals(text, std::string("1 4 2 5 3 0 "));
+}
+
+TEST(history, failed_tests_run_first_and_groups_are_renumbered)
+{
+    std::vector<detail::test_case> tests(6);
+    const char* names_of[][2] {{"A", "first"}, {"A", "second"},
+                               {"B", "first"}, {"B", "second"},
+                               {"C", "first"}, {"C", "second"}};
+    for(std::size_t i = 0; i < tests.size(); i++)
+    {
+        tests[i].record.group = names_of[i][0];
+        tests[i].record.name  = names_of[i][1];
+    }
+    detail::number_groups(tests);
+
+    detail::run_history last;
+    last.record("A.first", 10, false);
+    last.record("A.second", 10, false);
+    last.record("B.first", 10, false);
+    last.record("B.second", 10, true);
+    last.record("C.first", 10, true);
+
+    detail::run_failed_first(tests, last);
+
+    // Groups move whole, so B isn't split around its passed test
+    check_equals(names(tests),
+                 std::string("B.second#1/2 B.first#2/2 C.first#1/2 "
+                             "C.second#2/2 A.first#1/2 A.second#2/2 "));
+}
@@ -0,0 +1,147 @@
+#include <corgi/test/test.h>
+
+#ifdef CORGI_TEST_HAS_FORK
+
+#    include <chrono>
+#    include <csignal>
+#    include <cstdlib>
+#    include <thread>
+
+#    include <sys/wait.h>
+#    include <unistd.h>
+
+using namespace corgi::test;
+
+namespace
+{
+std::vector<detail::test_result>
+run_isolated(const std::vector<std::function<void()>>& functions,
+             std::chrono::milliseconds                 timeout = {})
+{
+    std::vector<detail::test_case> tests(functions.size());
+    for(std::size_t i = 0; i < functions.size(); i++)
+        tests[i].record = {"isolation", "test", nullptr,  nullptr,
+                           &functions[i], "",   timeout};
+
+    std::vector<detail::test_result> results;
+    detail::run_isolated(tests, 2,
+                         [&](std::size_t, const detail::test_result& result)
+                         { results.push_back(result); });
+    return results;
+}
+
+void exit_on_signal(int)
+{
+    ::_exit(3);
+}
+}    // namespace
+
+TEST(isolation, crash_only_fails_the_crashing_test)
+{
+    const auto results =
+        run_isolated({[]() {}, []() { std::abort(); }, []() {}});
+
+    check_equals(results.size(), std::size_t(3));
+    check_equals(results[0].errors, 0);
+    check_equals(results[1].errors, 1);
+    check_equals(results[2].errors, 0);
+    check_non_equals(results[1].output.find("Crashed with signal"),
+                     std::string::npos);
+}
+
+TEST(isolation, output_and_errors_come_back_from_the_child)
+{
+    const auto results = run_isolated(
+        {[]()
+         {
+             detail::write_line("before the failure");
+             detail::notify_error();
+             detail::notify_error();
+         }});
+
+    check_equals(results[0].errors, 2);
+    check_non_equals(results[0].output.find("before the failure"),
+                     std::string::npos);
+}
+
+TEST(isolation, hung_child_is_killed_and_the_run_goes_on)
+{
+    const auto start   = std::chrono::steady_clock::now();
+    const auto results = run_isolated(
+        {[]() {},
+         []()
+         {
+             detail::write_line("before hanging");
+             for(;;)
+                 std::this_thread::sleep_for(std::chrono::seconds(1));
+         },
+         []() {}},
+        std::chrono::milliseconds(200));
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    check_equals(results.size(), std::size_t(3));
+    check_equals(results[0].errors, 0);
+    check_equals(results[1].errors, 1);
+    check_equals(results[2].errors, 0);
+    check_non_equals(results[1].output.find("Timed out after"),
+                     std::string::npos);
+    check_non_equals(results[1].output.find("before hanging"),
+                     std::string::npos);
+    assert_that(elapsed < std::chrono::seconds(5), equals(true));
+}
+
+TEST(isolation, crash_handlers_are_given_back)
+{
+    struct sigaction own
+    {
+    };
+    own.sa_handler = &exit_on_signal;
+    sigemptyset(&own.sa_mask);
+
+    struct sigaction original
+    {
+    };
+    sigaction(SIGBUS, &own, &original);
+    {
+        detail::crash_handlers handlers;
+
+        struct sigaction during
+        {
+        };
+        sigaction(SIGBUS, nullptr, &during);
+        check_equals(during.sa_handler == &detail::flush_on_crash, true);
+    }
+
+    struct sigaction after
+    {
+    };
+    sigaction(SIGBUS, &original, &after);
+    check_equals(after.sa_handler == &exit_on_signal, true);
+}
+
+TEST(isolation, crashes_reach_the_previous_handler)
+{
+    const pid_t pid = ::fork();
+
+    if(pid == 0)
+    {
+        struct sigaction own
+        {
+        };
+        own.sa_handler = &exit_on_signal;
+        sigemptyset(&own.sa_mask);
+        sigaction(SIGABRT, &own, nullptr);
+
+        detail::flush_sink_on_crash = false;
+        detail::crash_handlers handlers;
+        std::abort();
+    }
+
+    int status {0};
+    ::waitpid(pid, &status, 0);
+
+    check_equals(WIFEXITED(status) != 0, true);
+    check_equals(WEXITSTATUS(status), 3);
+}
+
+#endif
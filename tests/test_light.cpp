@@ -0,0 +1,61 @@
+#include <corgi/test/runtime.h>
+#include <corgi/test/test.h>
+
+#include "reported_failures_scope.h"
+
+#include <string>
+#include <utility>
+
+using namespace corgi::test;
+
+// Made of checks from corgi/test/light.h, inside light_header.cpp
+void light_failing_checks();
+
+namespace
+{
+enum class level
+{
+    low  = 1,
+    high = 7
+};
+}    // namespace
+
+TEST(light, failures_are_reported_by_the_runtime)
+{
+    reported_failures_scope scope(10);
+
+    detail::test_context context;
+    auto* previous = std::exchange(detail::current_context, &context);
+
+    std::string output;
+    {
+        detail::capture_output capture(output);
+        light_failing_checks();
+    }
+    detail::current_context = previous;
+
+    check_equals(context.errors, 3);
+    check_non_equals(output.find("light_header.cpp"), std::string::npos);
+    check_non_equals(output.find("Check non equals"), std::string::npos);
+    check_non_equals(output.find("An exception was thrown"), std::string::npos);
+}
+
+TEST(light, light_tests_are_registered)
+{
+    bool found {false};
+    for(const auto& record : detail::registry)
+        found = found || (record.group == "light" &&
+                          record.name == "checks_pass" &&
+                          record.tags == "light");
+
+    check_equals(found, true);
+}
+
+TEST(light, values_are_formatted_without_streams)
+{
+    check_equals(runtime::format_value(42), std::string("42"));
+    check_equals(runtime::format_value('c'), std::string("c"));
+    check_equals(runtime::format_value(false), std::string("false"));
+    check_equals(runtime::format_value(level::high), std::string("7"));
+    check_equals(runtime::format_value("text"), std::string("text"));
+}
@@ -0,0 +1,99 @@
+#include <corgi/test/test.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace corgi::test;
+
+// Matchers on scalars are composed and evaluated at compile time
+static_assert(equals(4).run(4));
+static_assert(!non_equals(4).run(4));
+static_assert(greater_than(3).run(4));
+static_assert(!less_than(3).run(4));
+static_assert(in_range(1, 5).run(1) && in_range(1, 5).run(5));
+static_assert(!in_range(1, 5).run(6));
+static_assert(all_of(greater_than(0), less_than(10), non_equals(5)).run(4));
+static_assert(!all_of(greater_than(0), less_than(10)).run(10));
+static_assert(any_of(equals(1), equals(2)).run(2));
+static_assert(!any_of(equals(1), equals(2)).run(3));
+static_assert(not_(in_range(0, 9)).run(10));
+
+namespace
+{
+/*!
+ * @brief Errors reported by the checks made inside @p function
+ */
+template<class Function>
+int count_errors(Function&& function)
+{
+    detail::test_context context;
+    auto* previous = std::exchange(detail::current_context, &context);
+
+    std::string output;
+    {
+        detail::capture_output capture(output);
+        function();
+    }
+
+    detail::current_context = previous;
+    return context.errors;
+}
+}    // namespace
+
+TEST(matchers, compose_at_run_time)
+{
+    for(int i = 0; i < 100; i++)
+    {
+        assert_that(i, all_of(in_range(0, 99), not_(less_than(0))));
+        assert_that(i, any_of(less_than(50), greater_than(49)));
+    }
+    assert_that(2.5, all_of(greater_than(2.0), almost_equals(2.5, 1e-9)));
+}
+
+TEST(matchers, strings_are_referenced_not_copied)
+{
+    const std::string expected(100, 'x');
+    const Equals<std::string> matcher(expected);
+
+    assert_that(matcher.run(std::string(100, 'x')), equals(true));
+    assert_that(std::string("corgi"), equals("corgi"));
+}
+
+TEST(matchers, failing_matchers_are_reported)
+{
+    check_equals(count_errors([]() { assert_that(5, greater_than(5)); }), 1);
+    check_equals(count_errors([]() { assert_that(5, in_range(6, 9)); }), 1);
+    check_equals(count_errors(
+                     []() {
+                         assert_that(5, all_of(greater_than(0), equals(4)));
+                     }),
+                 1);
+    check_equals(count_errors([]() { assert_that(5, not_(equals(5))); }), 1);
+}
+
+TEST(matchers, pointers_to_matchers_still_work)
+{
+    assert_that(3, std::make_unique<Equals<int>>(3));
+}
+
+TEST(matchers, passing_checks_do_not_allocate)
+{
+    std::vector<int> values(10000);
+    for(int i = 0; i < 10000; i++)
+        values[static_cast<std::size_t>(i)] = i;
+
+    const std::string name(64, 'n');
+    const auto        start = detail::thread_allocations.allocations;
+
+    for(const auto value : values)
+    {
+        assert_that(value, all_of(greater_than(-1), less_than(10000)));
+        assert_that(name, equals(name));
+        check_equals(name, name);
+        check_non_equals(value, -1);
+    }
+
+    check_equals(detail::thread_allocations.allocations, start);
+}
@@ -0,0 +1,126 @@
+#include <corgi/test/test.h>
+
+#include <cstdio>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace corgi::test;
+
+namespace
+{
+std::string read_file(std::FILE* file)
+{
+    std::string content;
+    char        buffer[256];
+
+    std::rewind(file);
+    while(auto size = std::fread(buffer, 1, sizeof(buffer), file))
+        content.append(buffer, size);
+    return content;
+}
+}    // namespace
+
+TEST(output_sink, async_sink_keeps_blocks_in_order)
+{
+    std::FILE* file = std::tmpfile();
+    std::string expected;
+
+    {
+        async_sink sink(file);
+        for(int i = 0; i < 1000; i++)
+        {
+            const auto block = "block " + std::to_string(i) + "\n";
+            expected += block;
+            sink.write(block);
+        }
+        sink.flush();
+        check_equals(read_file(file), expected);
+    }
+    std::fclose(file);
+}
+
+TEST(output_sink, async_sink_takes_blocks_from_many_threads)
+{
+    const int  thread_count = 8;
+    const int  block_count  = 2000;
+    std::FILE* file         = std::tmpfile();
+
+    {
+        async_sink               sink(file);
+        std::vector<std::thread> threads;
+
+        for(int t = 0; t < thread_count; t++)
+            threads.emplace_back(
+                [&sink, t]()
+                {
+                    for(int i = 0; i < block_count; i++)
+                        sink.write(std::to_string(t) + " " +
+                                   std::to_string(i) + "\n");
+                });
+
+        for(auto& thread : threads)
+            thread.join();
+    }
+
+    // Every block is there once, and the blocks of a thread keep their order
+    std::vector<int>   next(thread_count, 0);
+    std::istringstream lines(read_file(file));
+    int                t {0};
+    int                i {0};
+    int                wrong {0};
+
+    while(lines >> t >> i)
+    {
+        if(t < 0 || t >= thread_count || next[t] != i)
+            wrong++;
+        else
+            next[t]++;
+    }
+
+    check_equals(wrong, 0);
+    for(const auto count : next)
+        check_equals(count, block_count);
+    std::fclose(file);
+}
+
+TEST(output_sink, async_sink_writes_everything_when_destroyed)
+{
+    std::FILE* file = std::tmpfile();
+
+    {
+        async_sink sink(file);
+        sink.write("first\n");
+        sink.write("second\n");
+    }
+
+    check_equals(read_file(file), std::string("first\nsecond\n"));
+    std::fclose(file);
+}
+
+TEST(output_sink, emergency_flush_skips_what_was_flushed)
+{
+    std::FILE* file = std::tmpfile();
+
+    {
+        async_sink sink(file);
+        sink.write("first\n");
+        sink.write("second\n");
+        sink.flush();
+        sink.emergency_flush();
+    }
+
+    check_equals(read_file(file), std::string("first\nsecond\n"));
+    std::fclose(file);
+}
+
+TEST(output_sink, captured_output_stays_in_the_buffer)
+{
+    std::string buffer;
+    {
+        detail::capture_output capture(buffer);
+        detail::write_line("captured", detail::color::Green);
+    }
+
+    check_non_equals(buffer.find("captured\033[0m\n"), std::string::npos);
+}
@@ -0,0 +1,208 @@
+#include <corgi/test/test.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace corgi::test;
+
+namespace
+{
+using choices = std::vector<std::uint64_t>;
+
+/*!
+ * @brief Value @p generator makes out of @p replayed
+ */
+template<class Generator>
+auto generate(const Generator& generator, choices replayed)
+{
+    detail::choice_source source(std::move(replayed));
+    return generator(source);
+}
+
+/*!
+ * @brief Shrinks what @p generator makes from @p seed while @p fails
+ */
+template<class Generator, class Fails>
+auto shrink_value(const Generator& generator, std::uint64_t seed, Fails fails)
+{
+    detail::choice_source random(seed);
+    if(!fails(generator(random)))
+        return generator(random);
+
+    std::size_t shrinks {0};
+    const auto  simplest = detail::shrink(
+        random.choices(),
+        [&](const choices& candidate)
+        { return fails(generate(generator, candidate)); },
+        10000, shrinks);
+
+    return generate(generator, simplest);
+}
+
+void failing_property()
+{
+    const auto value = draw(gen::integers<int>(0, 1000000));
+    assert_that(value, less_than(1000));
+}
+
+void throwing_property()
+{
+    if(draw(gen::strings()).size() > 3)
+        throw std::runtime_error("too long");
+}
+
+std::pair<int, std::string> run_property(void (*body)())
+{
+    const std::function<void()> property = [body]()
+    { detail::check_property("property.test", body); };
+
+    detail::test_case test;
+    test.record.group    = "property";
+    test.record.name     = "test";
+    test.record.callable = &property;
+
+    detail::test_result result;
+    std::string         output;
+    {
+        detail::capture_output capture(output);
+        detail::run_test(test, result);
+    }
+    return {result.errors, output};
+}
+}    // namespace
+
+TEST(property, integers_go_around_the_origin)
+{
+    const gen::integers<int> around_zero(-2, 3);
+
+    std::vector<int> values;
+    for(std::uint64_t choice = 0; choice < 6; choice++)
+        values.push_back(generate(around_zero, {choice}));
+
+    const std::vector<int> expected {0, 1, -1, 2, -2, 3};
+    check_equals(values == expected, true);
+
+    check_equals(generate(gen::integers<unsigned>(3, 9), {}), 3u);
+    check_equals(generate(gen::integers<int>(-9, -3), {}), -3);
+    check_equals(generate(gen::integers<int>(-9, -3), {100}), -9);
+}
+
+TEST(property, integers_cover_their_whole_range)
+{
+    const gen::integers<signed char> all;
+
+    std::set<int> seen;
+    for(std::uint64_t choice = 0; choice < 256; choice++)
+        seen.insert(generate(all, {choice}));
+
+    check_equals(seen.size(), std::size_t(256));
+
+    const gen::integers<std::int64_t> wide;
+    check_equals(generate(wide, {~std::uint64_t(0)}),
+                 std::numeric_limits<std::int64_t>::lowest());
+}
+
+TEST(property, generated_values_stay_in_bounds)
+{
+    const gen::reals<double> unit(-1.0, 1.0);
+    const auto               small = gen::vectors(gen::integers<int>(1, 6), 5);
+
+    detail::choice_source source(42);
+    for(int i = 0; i < 1000; i++)
+    {
+        assert_that(unit(source), in_range(-1.0, 1.0));
+
+        const auto values = small(source);
+        assert_that(values.size(), less_than(std::size_t(6)));
+        for(auto value : values)
+            assert_that(value, in_range(1, 6));
+    }
+}
+
+TEST(property, shrinking_finds_the_simplest_failure)
+{
+    const auto number = shrink_value(gen::integers<int>(0, 1000000), 7,
+                                     [](int value) { return value >= 1000; });
+    check_equals(number, 1000);
+
+    const auto values = shrink_value(
+        gen::vectors(gen::integers<int>(0, 50)), 11,
+        [](const std::vector<int>& v)
+        { return std::accumulate(v.begin(), v.end(), 0) >= 100; });
+    check_equals(std::accumulate(values.begin(), values.end(), 0), 100);
+
+    const auto text = shrink_value(gen::strings(), 3,
+                                   [](const std::string& s)
+                                   { return s.size() >= 2; });
+    check_equals(text, std::string("  "));
+}
+
+TEST(property, failures_are_shrunk_and_reported)
+{
+    const auto result = run_property(&failing_property);
+
+    check_equals(result.first, 2);
+    check_non_equals(result.second.find("Property failed"), std::string::npos);
+    check_non_equals(result.second.find("* drawn :    1000\033"),
+                     std::string::npos);
+
+    const auto thrown = run_property(&throwing_property);
+    check_non_equals(thrown.second.find("\"    \""), std::string::npos);
+    check_non_equals(thrown.second.find("too long"), std::string::npos);
+}
+
+TEST(property, describe)
+{
+    const std::vector<int> values {1, 2};
+    check_equals(detail::describe(values), std::string("{1, 2}"));
+    check_equals(detail::describe(std::make_tuple(1, std::string("a"), true)),
+                 std::string("(1, \"a\", true)"));
+    check_equals(detail::describe(std::vector<std::string> {}),
+                 std::string("{}"));
+}
+
+TEST(property, draw_outside_a_property_throws)
+{
+    check_throw(draw(gen::booleans()), std::logic_error);
+}
+
+TEST(property, options)
+{
+    char  name[]  = "test";
+    char  cases[] = "--property-cases=5000";
+    char  jobs[]  = "--property-jobs=2";
+    char  seed[]  = "--seed=1234";
+    char* argv[] {name, cases, jobs, seed};
+
+    const auto parsed = parse_options(4, argv);
+    check_equals(parsed.property_cases, std::size_t(5000));
+    check_equals(parsed.property_jobs, 2u);
+    check_equals(parsed.seed, 1234u);
+}
+
+PROPERTY(property, reversing_twice_changes_nothing)
+{
+    const auto values = draw(gen::vectors(gen::integers<int>()));
+
+    auto reversed = values;
+    std::reverse(reversed.begin(), reversed.end());
+    std::reverse(reversed.begin(), reversed.end());
+
+    check_equals(reversed == values, true);
+}
+
+PROPERTY(property, composed_generators)
+{
+    const auto [text, even] =
+        draw(gen::tuples(gen::strings(8),
+                         gen::map(gen::integers<int>(-1000, 1000),
+                                  [](int value) { return value * 2; })));
+
+    assert_that(text.size(), less_than(std::size_t(9)));
+    check_equals(even % 2, 0);
+}
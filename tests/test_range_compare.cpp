@@ -0,0 +1,215 @@
+#include <corgi/test/test.h>
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace corgi::test;
+
+namespace
+{
+/*!
+ * @brief Runs @p function with its own test context, and returns what it
+ * wrote and how many errors it reported
+ */
+template<class Function>
+std::pair<int, std::string> run_checks(Function&& function)
+{
+    detail::test_context context;
+    auto* previous = std::exchange(detail::current_context, &context);
+
+    std::string output;
+    {
+        detail::capture_output capture(output);
+        function();
+    }
+
+    detail::current_context = previous;
+    return {context.errors, output};
+}
+
+std::vector<float> ramp(std::size_t size)
+{
+    std::vector<float> values(size);
+    for(std::size_t i = 0; i < size; i++)
+        values[i] = static_cast<float>(i) * 0.5f - 100.0f;
+    return values;
+}
+
+/*!
+ * @brief Checks that the vectorized kernels count the same mismatches as
+ * the scalar loop
+ */
+template<class Match, class T>
+void check_kernel(const Match&          match,
+                  const std::vector<T>& a,
+                  const std::vector<T>& b)
+{
+    check_equals(
+        detail::count_failures(match, a.data(), b.data(), a.size()),
+        detail::count_failures_scalar(match, a.data(), b.data(), a.size()));
+}
+}    // namespace
+
+TEST(range_compare, equal_ranges_pass)
+{
+    const auto a = ramp(100003);
+    const auto b = a;
+
+    check_range_equals(a, b);
+    check_range_near(a, b, 0.0, 0.0);
+    check_range_ulps(a, b, 0);
+
+    const std::vector<int> integers {1, 2, 3};
+    const int              array[] {1, 2, 3};
+    check_range_equals(integers, array);
+}
+
+TEST(range_compare, mismatches_are_counted_and_located)
+{
+    const auto a = ramp(5000);
+    auto       b = a;
+
+    // Inside a block, at a block boundary and in the tail of the vectors
+    const std::size_t changed[] {3, 1023, 1024, 4097, 4999};
+    for(auto i : changed)
+        b[i] += 1.0f;
+
+    const auto found = detail::compare_ranges(
+        detail::exact_match {}, a.data(), b.data(), a.size());
+
+    check_equals(found.count, std::size_t(5));
+    for(std::size_t i = 0; i < 5; i++)
+        check_equals(found.indices[i], changed[i]);
+}
+
+TEST(range_compare, only_the_first_mismatches_are_kept)
+{
+    const auto a = ramp(10000);
+    auto       b = a;
+    for(std::size_t i = 100; i < 10000; i += 100)
+        b[i] = 0.25f;
+
+    const auto result = run_checks([&]() { check_range_equals(a, b); });
+
+    check_equals(result.first, 1);
+    check_non_equals(result.second.find("99 out of 10000"),
+                     std::string::npos);
+    check_non_equals(result.second.find("300 instead of 0.25"),
+                     std::string::npos);
+    check_equals(result.second.find("[900]"), std::string::npos);
+    check_non_equals(result.second.find("And 91 more"), std::string::npos);
+}
+
+TEST(range_compare, different_sizes_fail)
+{
+    const std::vector<double> a(10, 1.0);
+    const std::vector<double> b(11, 1.0);
+
+    const auto result = run_checks([&]() { check_range_equals(a, b); });
+
+    check_equals(result.first, 1);
+    check_non_equals(result.second.find("10 and 11"), std::string::npos);
+}
+
+TEST(range_compare, tolerances)
+{
+    const std::vector<double> a {1.0, 100.0, 0.0, 5.0};
+    const std::vector<double> b {1.001, 100.5, 1e-9, 5.0};
+
+    check_range_near(a, b, 1e-2, 1e-2);
+
+    const auto absolute_only =
+        run_checks([&]() { check_range_near(a, b, 1e-2, 0.0); });
+    check_equals(absolute_only.first, 1);
+    check_non_equals(absolute_only.second.find("1 out of 4"),
+                     std::string::npos);
+
+    const auto relative_only =
+        run_checks([&]() { check_range_near(a, b, 0.0, 1e-2); });
+    check_non_equals(relative_only.second.find("1 out of 4"),
+                     std::string::npos);
+}
+
+TEST(range_compare, ulps)
+{
+    const std::vector<float> a {1.0f, -0.0f, -1.0f, 1e-30f};
+    std::vector<float>       b {std::nextafter(1.0f, 2.0f), 0.0f,
+                                std::nextafter(-1.0f, -2.0f), 1e-30f};
+
+    check_range_ulps(a, b, 1);
+
+    b[0] = std::nextafter(b[0], 2.0f);
+    const auto result = run_checks([&]() { check_range_ulps(a, b, 1); });
+    check_non_equals(result.second.find("1 out of 4"), std::string::npos);
+
+    // The smallest positive and negative floats are 2 ulps apart
+    const float tiny = std::numeric_limits<float>::denorm_min();
+    const std::vector<float> positive {tiny};
+    const std::vector<float> negative {-tiny};
+    check_range_ulps(positive, negative, 2);
+}
+
+TEST(range_compare, nan_and_infinity_never_match_loosely)
+{
+    const float nan      = std::numeric_limits<float>::quiet_NaN();
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    const std::vector<float> a {nan, infinity, 1.0f, infinity};
+    const std::vector<float> b {nan, 1.0f, infinity, infinity};
+
+    const detail::near_match loose {1e30, 1.0};
+    const detail::ulp_match  far {1ull << 40};
+
+    check_equals(detail::compare_ranges(loose, a.data(), b.data(), 4).count,
+                 std::size_t(3));
+    check_equals(detail::compare_ranges(far, a.data(), b.data(), 4).count,
+                 std::size_t(1));
+}
+
+TEST(range_compare, kernels_match_the_scalar_loop)
+{
+    std::vector<float>  a;
+    std::vector<float>  b;
+    std::vector<double> da;
+    std::vector<double> db;
+
+    const float special[] {0.0f,
+                           -0.0f,
+                           1.0f,
+                           -1.0f,
+                           1e-38f,
+                           -1e-38f,
+                           std::numeric_limits<float>::max(),
+                           -std::numeric_limits<float>::max(),
+                           std::numeric_limits<float>::infinity(),
+                           -std::numeric_limits<float>::infinity(),
+                           std::numeric_limits<float>::quiet_NaN(),
+                           std::numeric_limits<float>::denorm_min()};
+
+    for(auto x : special)
+        for(auto y : special)
+            for(auto delta : {0.0f, 1e-7f, 1e-3f})
+            {
+                a.push_back(x);
+                b.push_back(y + delta);
+                da.push_back(x);
+                db.push_back(static_cast<double>(y) + delta);
+            }
+
+    for(double tolerance : {0.0, 1e-6, 1e-2, 1e40})
+    {
+        check_kernel(detail::near_match {tolerance, 0.0}, a, b);
+        check_kernel(detail::near_match {0.0, tolerance}, a, b);
+        check_kernel(detail::near_match {tolerance, 0.0}, da, db);
+        check_kernel(detail::near_match {0.0, tolerance}, da, db);
+    }
+
+    for(std::uint64_t ulps : {0ull, 1ull, 100ull, 1ull << 31, 1ull << 40})
+        check_kernel(detail::ulp_match {ulps}, a, b);
+
+    check_kernel(detail::exact_match {}, a, b);
+    check_kernel(detail::exact_match {}, da, db);
+}
@@ -0,0 +1,69 @@
+#include <corgi/test/test.h>
+
+using namespace corgi::test;
+
+namespace
+{
+void empty_function() {}
+}    // namespace
+
+TEST(registry, groups_are_numbered_separately)
+{
+    std::vector<detail::test_case> tests(4);
+    tests[0].record = {"a", "x", &empty_function, nullptr, nullptr, ""};
+    tests[1].record = {"a", "y", &empty_function, nullptr, nullptr, ""};
+    tests[2].record = {"b", "x", &empty_function, nullptr, nullptr, ""};
+    tests[3].record = {"b", "y", nullptr, &detail::make_fixture<Test>, nullptr,
+                       ""};
+
+    detail::number_groups(tests);
+
+    check_equals(tests[1].index, std::size_t(2));
+    check_equals(tests[1].group_size, std::size_t(2));
+    check_equals(tests[2].group_size, std::size_t(1));
+    check_equals(tests[3].index, std::size_t(1));
+}
+
+TEST(registry, test_macro_registers_its_function)
+{
+    bool found = false;
+    for(const auto& record : detail::registry)
+        if(record.group == "registry" &&
+           record.name == "test_macro_registers_its_function")
+            found = record.function != nullptr;
+
+    assert_that(found, equals(true));
+}
+
+TEST(registry, only_the_first_registration_of_a_name_is_kept)
+{
+    void (*other_function)() = []() {};
+
+    std::vector<detail::test_record> records {
+        {"a", "x", &empty_function, nullptr, nullptr, ""},
+        {"a", "y", &empty_function, nullptr, nullptr, ""},
+        {"a", "x", other_function, nullptr, nullptr, ""},
+        {"a", "x", nullptr, &detail::make_fixture<Test>, nullptr, ""}};
+
+    const auto duplicates = detail::sort_registry(records);
+
+    check_equals(records.size(), std::size_t(3));
+    check_equals(duplicates.size(), std::size_t(1));
+    check_equals(duplicates[0], std::string("a.x"));
+    check_equals(records[1].function == &empty_function, true);
+}
+
+TEST(registry, duplicates_are_not_written_to_the_output)
+{
+    std::vector<detail::test_record> records {
+        {"a", "x", &empty_function, nullptr, nullptr, ""},
+        {"a", "x", &empty_function, nullptr, nullptr, ""}};
+
+    std::string output;
+    {
+        detail::capture_output capture(output);
+        detail::select_tests(records, options {});
+    }
+
+    check_equals(output, std::string());
+}
@@ -0,0 +1,195 @@
+#include <corgi/test/test.h>
+
+#include <algorithm>
+#include <cstdio>
+
+using namespace corgi::test;
+
+namespace
+{
+std::string read_file(std::FILE* file)
+{
+    std::string content;
+    char        buffer[256];
+
+    std::rewind(file);
+    while(auto size = std::fread(buffer, 1, sizeof(buffer), file))
+        content.append(buffer, size);
+    return content;
+}
+
+test_report make_report(std::string_view name, size_t index, int errors)
+{
+    test_report report;
+    report.group      = "io";
+    report.name       = name;
+    report.index      = index;
+    report.group_size = 2;
+    report.errors     = errors;
+    report.time       = 1500;
+    return report;
+}
+
+benchmark make_benchmark()
+{
+    return benchmark("sort", 2,
+                     {{"std::sort", []() {}}, {"bubble <sort>", []() {}}});
+}
+
+benchmark_result make_benchmark_result()
+{
+    benchmark_result result;
+    result.results.resize(2);
+    result.results[0].median_time = 10.0;
+    result.results[0].total_time  = 2e9;
+    result.results[0].samples     = {10.0, 11.0};
+    result.results[1].median_time = 50.0;
+    result.results[1].samples     = {50.0};
+    result.fastest                = 0;
+    result.comparisons.push_back({1, {5.0, 4.5, 5.5}});
+    return result;
+}
+}    // namespace
+
+TEST(reporter, json_lines_has_one_event_per_line)
+{
+    std::FILE* file = std::tmpfile();
+    {
+        json_lines_reporter reporter(file);
+        reporter.run_started(2);
+        reporter.test_finished(make_report("read \"file\"", 1, 0));
+        reporter.test_finished(make_report("write", 2, 3));
+        reporter.run_finished(3);
+    }
+
+    std::string expected =
+        "{\"event\":\"run_start\",\"tests\":2}\n"
+        "{\"event\":\"test\",\"group\":\"io\",\"name\":\"read \\\"file\\\"\","
+        "\"passed\":true,\"errors\":0,\"time_us\":1500";
+    if(detail::allocation_tracking)
+        expected += ",\"allocations\":0,\"allocated_bytes\":0,\"peak_bytes\":0";
+    expected += "}\n";
+
+    const auto content = read_file(file);
+    check_equals(content.substr(0, expected.size()), expected);
+    check_non_equals(content.find("\"errors\":3,"), std::string::npos);
+    check_equals(content.substr(content.rfind("{\"event\"")),
+                 std::string("{\"event\":\"run_end\",\"errors\":3}\n"));
+    std::fclose(file);
+}
+
+TEST(reporter, json_lines_carries_benchmark_statistics)
+{
+    const auto bench  = make_benchmark();
+    const auto result = make_benchmark_result();
+
+    std::FILE* file = std::tmpfile();
+    {
+        json_lines_reporter reporter(file);
+        reporter.benchmark_finished(bench, result);
+    }
+
+    const auto content = read_file(file);
+    check_equals(content.find("{\"event\":\"benchmark\",\"name\":\"sort\""),
+                 std::size_t(0));
+    check_non_equals(content.find("\"median_ns\":10,"), std::string::npos);
+    check_non_equals(content.find("\"samples_ns\":[10,11]"),
+                     std::string::npos);
+    check_non_equals(content.find("\"fastest\":\"std::sort\""),
+                     std::string::npos);
+    check_non_equals(
+        content.find("{\"candidate\":\"bubble <sort>\",\"slowdown\":5,"
+                     "\"lower\":4.5,\"upper\":5.5,\"significant\":true}"),
+        std::string::npos);
+    check_equals(std::count(content.begin(), content.end(), '\n'),
+                 std::ptrdiff_t(1));
+    std::fclose(file);
+}
+
+TEST(reporter, junit_opens_and_closes_a_suite_per_group)
+{
+    std::FILE* file = std::tmpfile();
+    {
+        junit_reporter reporter(file);
+        reporter.run_started(2);
+        reporter.test_finished(make_report("read", 1, 0));
+        reporter.test_finished(make_report("<write>", 2, 3));
+        reporter.run_finished(3);
+    }
+
+    check_equals(
+        read_file(file),
+        std::string(
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n"
+            "  <testsuite name=\"io\" tests=\"2\">\n"
+            "    <testcase classname=\"io\" name=\"read\" time=\"0.001500\"/>\n"
+            "    <testcase classname=\"io\" name=\"&lt;write&gt;\" "
+            "time=\"0.001500\">\n"
+            "      <failure message=\"3 failed checks\"/>\n"
+            "    </testcase>\n"
+            "  </testsuite>\n"
+            "</testsuites>\n"));
+    std::fclose(file);
+}
+
+TEST(reporter, junit_closes_a_suite_cut_short_by_fail_fast)
+{
+    auto skipped    = make_report("write", 2, 0);
+    skipped.skipped = true;
+    skipped.time    = 0;
+
+    auto other  = make_report("parse", 1, 0);
+    other.group = "json";
+
+    std::FILE* file = std::tmpfile();
+    {
+        junit_reporter reporter(file);
+        reporter.run_started(3);
+        reporter.test_finished(make_report("read", 1, 1));
+        reporter.test_finished(skipped);
+        reporter.test_finished(other);
+        reporter.run_finished(1);
+    }
+
+    const auto content = read_file(file);
+    check_non_equals(content.find("name=\"write\" time=\"0.000000\">\n"
+                                  "      <skipped/>\n"
+                                  "    </testcase>\n"
+                                  "  </testsuite>\n"
+                                  "  <testsuite name=\"json\""),
+                     std::string::npos);
+    const std::string end = "\"/>\n  </testsuite>\n</testsuites>\n";
+    check_equals(content.substr(content.size() - end.size()), end);
+    std::fclose(file);
+}
+
+TEST(reporter, junit_reports_benchmark_candidates_as_test_cases)
+{
+    const auto bench  = make_benchmark();
+    const auto result = make_benchmark_result();
+
+    std::FILE* file = std::tmpfile();
+    {
+        junit_reporter reporter(file);
+        reporter.benchmark_finished(bench, result);
+    }
+
+    const auto content = read_file(file);
+    check_equals(content.find("  <testsuite name=\"sort\" tests=\"2\">\n"),
+                 std::size_t(0));
+    check_non_equals(content.find("<testcase classname=\"sort\" "
+                                  "name=\"std::sort\" time=\"2.000000\">"),
+                     std::string::npos);
+    check_non_equals(
+        content.find("<property name=\"median_ns\" value=\"50\"/>"),
+        std::string::npos);
+    check_non_equals(content.find("name=\"bubble &lt;sort&gt;\""),
+                     std::string::npos);
+    std::fclose(file);
+}
+
+TEST(reporter, unwritable_report_file_throws)
+{
+    check_throw(json_lines_reporter("/nonexistent/directory/report.jsonl"),
+                std::runtime_error);
+}
@@ -0,0 +1,126 @@
+#include <corgi/test/test.h>
+
+#include <cstdint>
+#include <stdexcept>
+
+using namespace corgi::test;
+
+namespace
+{
+const char* const test_names[] = {"alpha", "beta",  "gamma", "delta",
+                                  "omega", "kappa", "sigma", "theta"};
+
+std::vector<detail::test_case> make_tests()
+{
+    std::vector<detail::test_case> tests;
+    for(const auto* name : test_names)
+    {
+        detail::test_case test;
+        test.record.group = "shard";
+        test.record.name  = name;
+        tests.push_back(test);
+    }
+    detail::number_groups(tests);
+    return tests;
+}
+
+std::vector<std::vector<detail::test_case>>
+make_shards(std::size_t count, const detail::run_history* history)
+{
+    std::vector<std::vector<detail::test_case>> shards;
+    for(std::size_t i = 0; i < count; i++)
+    {
+        shards.push_back(make_tests());
+        detail::shard_tests(shards.back(), i, count, history);
+    }
+    return shards;
+}
+}    // namespace
+
+TEST(shard, stable_hash_is_fnv1a)
+{
+    using hash = std::uint64_t;
+
+    check_equals(detail::stable_hash(""), hash(14695981039346656037ull));
+    check_equals(detail::stable_hash("a"), hash(0xaf63dc4c8601ec8cull));
+}
+
+TEST(shard, every_test_lands_in_exactly_one_shard)
+{
+    const auto shards = make_shards(3, nullptr);
+
+    std::map<std::string, int> seen;
+    for(const auto& shard : shards)
+        for(const auto& test : shard)
+            seen[std::string(test.record.name)]++;
+
+    check_equals(seen.size(), std::size_t(8));
+    for(const auto& [name, count] : seen)
+        check_equals(count, 1);
+
+    // The same shard is picked every time
+    check_equals(make_shards(3, nullptr)[1].size(), shards[1].size());
+}
+
+TEST(shard, groups_are_renumbered_inside_a_shard)
+{
+    const auto shards = make_shards(2, nullptr);
+
+    for(const auto& shard : shards)
+        for(std::size_t i = 0; i < shard.size(); i++)
+        {
+            check_equals(shard[i].index, i + 1);
+            check_equals(shard[i].group_size, shard.size());
+        }
+}
+
+TEST(shard, history_balances_the_durations)
+{
+    detail::run_history history;
+    history.record("shard.alpha", 800, false);
+    history.record("shard.beta", 700, false);
+    history.record("shard.gamma", 300, false);
+    history.record("shard.delta", 200, false);
+    history.record("shard.omega", 100, false);
+    history.record("shard.kappa", 100, false);
+    // sigma and theta never ran, they count as the mean : 366
+
+    const auto shards = make_shards(2, &history);
+
+    long long totals[2] {0, 0};
+    for(std::size_t i = 0; i < 2; i++)
+        for(const auto& test : shards[i])
+        {
+            const auto* found = history.find(detail::full_name(test.record));
+            totals[i] += found != nullptr ? found->time : 366;
+        }
+
+    check_equals(shards[0].size() + shards[1].size(), std::size_t(8));
+    check_equals(totals[0] + totals[1], 2932ll);
+    check_equals(std::max(totals[0], totals[1]) -
+                         std::min(totals[0], totals[1]) <=
+                     366,
+                 true);
+}
+
+TEST(shard, balance_spreads_tests_too_quick_to_be_measured)
+{
+    const auto shards = detail::balance_shards({1, 1, 1, 1, 1, 1}, 3);
+
+    std::size_t counts[3] {0, 0, 0};
+    for(auto shard : shards)
+        counts[shard]++;
+
+    check_equals(counts[0], std::size_t(2));
+    check_equals(counts[1], std::size_t(2));
+    check_equals(counts[2], std::size_t(2));
+}
+
+TEST(shard, index_must_be_lower_than_count)
+{
+    auto tests = make_tests();
+    check_throw(detail::shard_tests(tests, 2, 2, nullptr),
+                std::invalid_argument);
+    check_throw(detail::shard_tests(tests, 0, 0, nullptr),
+                std::invalid_argument);
+}
@@ -0,0 +1,92 @@
+#include <corgi/test/test.h>
+
+using namespace corgi::test;
+
+TEST(statistics, percentiles_are_interpolated)
+{
+    const std::vector<double> sorted {1.0, 2.0, 3.0, 4.0, 5.0};
+
+    check_equals(detail::percentile(sorted, 50.0), 3.0);
+    check_equals(detail::percentile(sorted, 0.0), 1.0);
+    check_equals(detail::percentile(sorted, 100.0), 5.0);
+    assert_that(detail::percentile(sorted, 90.0), almost_equals(4.6, 1e-9));
+}
+
+TEST(statistics, outliers_use_the_median_absolute_deviation)
+{
+    const auto result =
+        detail::compute_statistics({10.0, 11.0, 9.0, 10.0, 10.5, 9.5, 100.0});
+
+    check_equals(result.median, 10.0);
+    check_equals(result.mad, 0.5);
+    check_equals(result.outliers, std::size_t(1));
+    check_equals(result.max, 100.0);
+    check_equals(result.min, 9.0);
+}
+
+TEST(statistics, single_sample)
+{
+    const auto result = detail::compute_statistics({42.0});
+
+    check_equals(result.median, 42.0);
+    check_equals(result.stddev, 0.0);
+    check_equals(result.outliers, std::size_t(0));
+}
+
+TEST(statistics, benchmark_measures_calls_under_a_microsecond)
+{
+    benchmark_settings settings;
+    settings.warmup_time = std::chrono::milliseconds(1);
+    settings.sample_time = std::chrono::microseconds(200);
+
+    volatile int counter = 0;
+    const auto   result  = run_benchmark_function(
+        [&]() { counter = counter + 1; }, 5, settings);
+
+    check_equals(result.samples.size(), std::size_t(5));
+    assert_that(result.iterations > 1, equals(true));
+    assert_that(result.median_time > 0.0, equals(true));
+}
+
+namespace
+{
+detail::complexity_fit fit(double (*model)(double))
+{
+    std::vector<double> sizes;
+    std::vector<double> times;
+
+    // A few percents of noise, alternating up and down
+    for(double n = 1000.0; n <= 1024000.0; n *= 4.0)
+    {
+        sizes.push_back(n);
+        times.push_back(model(n) * (sizes.size() % 2 == 0 ? 1.03 : 0.97));
+    }
+    return detail::fit_complexity(sizes, times);
+}
+
+std::string fitted(double (*model)(double))
+{
+    return detail::to_string(fit(model).big_o);
+}
+}    // namespace
+
+TEST(statistics, fits_the_complexity_of_measures)
+{
+    using namespace std::string_literals;
+
+    check_equals(fitted([](double) { return 50.0; }), "O(1)"s);
+    check_equals(fitted([](double n) { return 20.0 * std::log2(n); }),
+                 "O(log n)"s);
+    check_equals(fitted([](double n) { return 3.0 * n; }), "O(n)"s);
+    check_equals(fitted([](double n) { return 2.0 * n * std::log2(n); }),
+                 "O(n log n)"s);
+    check_equals(fitted([](double n) { return 0.5 * n * n; }), "O(n^2)"s);
+}
+
+TEST(statistics, complexity_fit_gives_the_coefficient)
+{
+    const auto result = fit([](double n) { return 3.0 * n; });
+
+    assert_that(result.coefficient, almost_equals(3.0, 0.1));
+    assert_that(result.rms < 0.05, equals(true));
+}
@@ -0,0 +1,124 @@
+#include <corgi/test/test.h>
+
+#include "reported_failures_scope.h"
+
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace corgi::test;
+
+namespace
+{
+/*!
+ * @brief Runs @p body like the runner would, and returns its errors and
+ * output
+ */
+std::pair<int, std::string> run_body(const std::function<void()>& body,
+                                     bool                         alone)
+{
+    detail::test_case test;
+    test.record.group    = "threads";
+    test.record.name     = "body";
+    test.record.callable = &body;
+
+    detail::test_result result;
+    std::string         output;
+    {
+        detail::capture_output capture(output);
+        detail::run_test(test, result, alone);
+    }
+    return {result.errors, output};
+}
+
+std::size_t count(const std::string& text, const std::string& pattern)
+{
+    std::size_t found {0};
+    for(auto i = text.find(pattern); i != std::string::npos;
+        i = text.find(pattern, i + 1))
+        found++;
+    return found;
+}
+}    // namespace
+
+TEST(threads, spawned_threads_report_to_their_test)
+{
+    reported_failures_scope scope(10);
+
+    const auto result = run_body(
+        []()
+        {
+            std::vector<std::thread> threads;
+            for(int i = 0; i < 4; i++)
+                threads.push_back(spawn(
+                    [i]()
+                    {
+                        for(int j = 0; j < 50; j++)
+                        {
+                            check_equals(i, i);
+                            check_equals(j, -1);
+                        }
+                    }));
+
+            for(auto& thread : threads)
+                thread.join();
+        },
+        false);
+
+    check_equals(result.first, 200);
+    check_equals(count(result.second, "! Error"), std::size_t(10));
+
+    // Every report is written in one piece, its line right after its file
+    const auto  end   = result.second.find("more failures");
+    std::size_t start = result.second.find("! Error");
+    while(start < end)
+    {
+        const auto next = std::min(result.second.find("! Error", start + 1),
+                                   end);
+        const auto report = result.second.substr(start, next - start);
+
+        check_equals(count(report, "* file :"), std::size_t(1));
+        check_equals(count(report, "* line :"), std::size_t(1));
+        start = next;
+    }
+}
+
+TEST(threads, unattached_threads_report_to_the_lone_test)
+{
+    const auto result = run_body(
+        []()
+        {
+            std::thread thread([]() { check_equals(1, 2); });
+            thread.join();
+        },
+        true);
+
+    check_equals(result.first, 1);
+    check_equals(count(result.second, "! Error"), std::size_t(1));
+}
+
+TEST(threads, threads_know_their_test)
+{
+    const auto test = current_test();
+    check_non_equals(test.context, static_cast<detail::test_context*>(nullptr));
+
+    detail::test_context* seen {nullptr};
+    auto thread = spawn([&]() { seen = current_test().context; });
+    thread.join();
+
+    check_equals(seen, test.context);
+}
+
+TEST(threads, failure_records_keep_their_order)
+{
+    detail::failure_records records;
+    records.push("a");
+    records.push("b");
+    records.push("c");
+
+    const auto taken = records.take();
+    check_equals(taken.size(), std::size_t(3));
+    check_equals(taken[0] + taken[1] + taken[2], std::string("abc"));
+    check_equals(records.take().size(), std::size_t(0));
+}
@@ -0,0 +1,136 @@
+#include <corgi/test/test.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace corgi::test;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct timeouts
+{
+    using report = std::pair<std::string, std::chrono::milliseconds>;
+
+    std::mutex              mutex;
+    std::condition_variable changed;
+    std::vector<report>     reported;
+
+    detail::watchdog::timeout_function function()
+    {
+        return [this](const std::string&        name,
+                      std::chrono::milliseconds elapsed)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                reported.emplace_back(name, elapsed);
+            }
+            changed.notify_all();
+        };
+    }
+
+    /*!
+     * @brief Waits until @p expected tasks were reported. The limit is only
+     * there so a broken watchdog fails the test instead of hanging it
+     */
+    bool wait_for(std::size_t expected)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        return changed.wait_for(lock, 10s,
+                                [&]() { return reported.size() >= expected; });
+    }
+};
+
+const detail::test_record* find_record(std::string_view group,
+                                       std::string_view name)
+{
+    for(const auto& record : detail::registry)
+        if(record.group == group && record.name == name)
+            return &record;
+    return nullptr;
+}
+
+long long timeout_of(const detail::test_record& record)
+{
+    return static_cast<long long>(record.timeout.count());
+}
+}    // namespace
+
+TEST(timeout, watchdog_reports_late_tasks_once)
+{
+    timeouts found;
+    {
+        detail::watchdog watchdog(found.function());
+
+        const auto late = watchdog.watch("late.task", 20ms);
+        check_equals(found.wait_for(1), true);
+
+        // Another report could only come later, so waiting can't fail it
+        std::this_thread::sleep_for(50ms);
+        watchdog.release(late);
+    }
+
+    check_equals(found.reported.size(), std::size_t(1));
+    check_equals(found.reported[0].first, std::string("late.task"));
+    assert_that(found.reported[0].second >= 20ms, equals(true));
+}
+
+TEST(timeout, watchdog_ignores_tasks_released_in_time)
+{
+    timeouts found;
+    {
+        detail::watchdog watchdog(found.function());
+
+        // Released long before their deadline, however loaded the machine
+        for(int i = 0; i < 50; i++)
+            watchdog.release(watchdog.watch("quick.task", 1h));
+
+        const auto slow = watchdog.watch("slow.task", 10ms);
+        check_equals(found.wait_for(1), true);
+        watchdog.release(slow);
+    }
+    check_equals(found.reported.size(), std::size_t(1));
+    check_equals(found.reported[0].first, std::string("slow.task"));
+}
+
+struct SlowFixture : public Test
+{
+    static constexpr auto timeout = 30s;
+};
+
+TEST_F(SlowFixture, gets_the_fixture_timeout) {}
+
+TIMED_TEST(timeout, timed_test, 1500ms) {}
+
+TEST(timeout, timeouts_are_registered)
+{
+    const auto* fixture =
+        find_record("SlowFixture", "gets_the_fixture_timeout");
+    const auto* timed   = find_record("timeout", "timed_test");
+    const auto* plain   = find_record("timeout", "timeouts_are_registered");
+
+    assert_that(fixture != nullptr && timed != nullptr && plain != nullptr,
+                equals(true));
+    check_equals(timeout_of(*fixture), 30000ll);
+    check_equals(timeout_of(*timed), 1500ll);
+    check_equals(timeout_of(*plain), 0ll);
+}
+
+TEST(timeout, run_timeout_applies_to_tests_without_their_own)
+{
+    std::vector<detail::test_record> records = {
+        {"a", "own", nullptr, nullptr, nullptr, "", 100ms},
+        {"a", "none", nullptr, nullptr, nullptr, ""}};
+
+    options run_options;
+    run_options.timeout = 5000ms;
+
+    const auto tests = detail::select_tests(records, run_options);
+
+    check_equals(tests.size(), std::size_t(2));
+    check_equals(tests[0].record.name, std::string_view("none"));
+    check_equals(timeout_of(tests[0].record), 5000ll);
+    check_equals(timeout_of(tests[1].record), 100ll);
+}
@@ -0,0 +1,65 @@
+#include <corgi/test/test.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+using namespace corgi::test;
+
+TEST(work_stealing_pool, runs_every_task_once)
+{
+    const std::size_t             task_count = 1000;
+    std::vector<std::atomic<int>> runs(task_count);
+    std::vector<std::size_t>      tasks(task_count);
+
+    for(std::size_t i = 0; i < task_count; i++)
+        tasks[i] = i;
+
+    detail::work_stealing_pool pool(8, tasks,
+                                    [&](std::size_t task) { runs[task]++; });
+    pool.join();
+
+    int wrong_count = 0;
+    for(const auto& run : runs)
+        if(run != 1)
+            wrong_count++;
+
+    check_equals(wrong_count, 0);
+}
+
+TEST(work_stealing_pool, idle_workers_steal)
+{
+    // Tasks are dealt round robin, so with 2 workers both real tasks land in
+    // the first worker's queue. The first one waits for the second, which can
+    // only run if the idle worker steals it
+    const std::size_t              skipped = 100;
+    const std::vector<std::size_t> tasks {0, skipped, 1};
+
+    std::mutex              mutex;
+    std::condition_variable stolen;
+    bool                    second_ran {false};
+    bool                    first_waited {false};
+
+    detail::work_stealing_pool pool(
+        2, tasks,
+        [&](std::size_t task)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            if(task == 1)
+            {
+                second_ran = true;
+                stolen.notify_all();
+            }
+            else if(task == 0)
+            {
+                // The limit only keeps a broken pool from hanging the test
+                first_waited = stolen.wait_for(lock, std::chrono::seconds(10),
+                                               [&]() { return second_ran; });
+            }
+        });
+    pool.join();
+
+    check_equals(first_waited, true);
+}